@@ -0,0 +1,171 @@
+#include "anytime.h"
+
+#include <random>
+#include <tuple>
+#include <algorithm>
+
+
+bool betterPlanning(int makespan, int energy, int otherMakespan, int otherEnergy, int desiredTime) noexcept {
+    // Below the desired time the makespan only breaks ties
+    const auto key = [desiredTime](int makespan, int energy){
+        return std::make_tuple(std::max(makespan, desiredTime), energy, makespan);
+    };
+    return key(makespan, energy) < key(otherMakespan, otherEnergy);
+}
+
+enum class Move {
+    SpeedUp,
+    SlowDown,
+    PolicySwap,
+    Migration,
+    Reordering
+};
+
+AnytimeSearch searchPlanning(TaskGraph& taskGraph, CriticalPathTracker& criticalPathTracker,
+        const std::vector<int>& rootTaskIndices, int desiredTime, int coresCount, PlanningStuff& planningStuff,
+        const AnytimeBudget& budget, std::chrono::steady_clock::time_point start) {
+    const auto elapsedMs = [&start](){
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+    const auto& compactTaskGraph = criticalPathTracker.compactTaskGraph;
+    const int tasksCount = compactTaskGraph.tasksCount;
+    const int policiesCount = compactTaskGraph.policiesCount;
+    AnytimeSearch search;
+    search.startMakespan = search.makespan = planningStuff.finishedAt();
+    search.startEnergy = search.energy = plannedEnergy(taskGraph, compactTaskGraph, planningStuff);
+    if (tasksCount == 0) return search;
+    const auto& processors = planningStuff.processors;
+    const bool anyMove = policiesCount > 1 || coresCount > 1 || std::any_of(processors.begin(), processors.end(),
+            [](const auto& processor){ return processor.processingTimeline.size() > 1; });
+    if (!anyMove) return search;
+
+    // With the one scheduler every move is replayed rather than planned anew.
+    // The makespans of the schedulers stay those of the planning searched from.
+    auto& schedulers = planningStuff.schedulers;
+    const std::vector<Scheduler> searchedFrom(schedulers);
+    const std::vector<int> makespanOf(planningStuff.makespanOf);
+    schedulers.assign(1, planningStuff.scheduler);
+    auto& pinnedCoreOf = planningStuff.pinnedCoreOf;
+    auto& priorityBiasOf = planningStuff.priorityBiasOf;
+    pinnedCoreOf.assign(tasksCount, -1);
+    priorityBiasOf.assign(tasksCount, 0);
+
+    // Of the current planning, which planningStuff always holds between moves.
+    // A move that is not kept is undone by copying it back from accepted.
+    int makespan = search.makespan, energy = search.energy;
+    PlanningStuff accepted;
+    copyPlanning(planningStuff, accepted);
+    std::vector<int> bestPolicies(tasksCount);
+    for (int id = 0; id < tasksCount; id++) bestPolicies[id] = taskGraph.tasks[id].policy;
+    std::vector<int> bestPinnedCoreOf(pinnedCoreOf);
+    std::vector<long long> bestPriorityBiasOf(priorityBiasOf);
+
+    Trace* const trace = planningStuff.trace;
+    const auto setPolicy = [&taskGraph, &criticalPathTracker, trace](int id, int policy){
+        auto& task = taskGraph.tasks[id];
+        if (trace && policy < task.policy) trace->count(Trace::Counter::PolicyDecrements);
+        task.policy = policy;
+        criticalPathTracker.taskChanged(id);
+    };
+    // What the Tasks a move changes were before it: <Task, policy, pinned core, priority bias>
+    std::vector<std::tuple<int, int, int, long long>> undo;
+    const auto remember = [&taskGraph, &pinnedCoreOf, &priorityBiasOf, &undo](int id){
+        undo.emplace_back(id, taskGraph.tasks[id].policy, pinnedCoreOf[id], priorityBiasOf[id]);
+    };
+
+    std::mt19937 engine(budget.seed);
+    std::uniform_int_distribution<int> randomTask(0, tasksCount - 1);
+    std::uniform_int_distribution<int> randomMove(0, static_cast<int>(Move::Reordering));
+    for (int draw = 0; draw < budget.moves; draw++) {
+        if (elapsedMs() >= budget.milliseconds) break;
+        if (budget.cancelled && budget.cancelled->load(std::memory_order_relaxed)) {
+            search.cancelled = true;
+            break;
+        }
+
+        // A move that does not apply to the Task drawn is drawn again
+        undo.clear();
+        const int id = randomTask(engine);
+        const int policy = taskGraph.tasks[id].policy;
+        switch (static_cast<Move>(randomMove(engine))) {
+            case Move::SpeedUp:
+                if (policy == 0) continue;
+                remember(id);
+                setPolicy(id, policy - 1);
+                break;
+            case Move::SlowDown:
+                if (policy + 1 == policiesCount) continue;
+                remember(id);
+                setPolicy(id, policy + 1);
+                break;
+            case Move::PolicySwap: {
+                const int slower = randomTask(engine);
+                if (policy == 0 || slower == id || taskGraph.tasks[slower].policy + 1 == policiesCount) continue;
+                remember(id);
+                remember(slower);
+                setPolicy(id, policy - 1);
+                setPolicy(slower, taskGraph.tasks[slower].policy + 1);
+                break;
+            }
+            case Move::Migration: {
+                if (coresCount < 2) continue;
+                const int core = planningStuff.assignmentOf[id].first;
+                const int to = std::uniform_int_distribution<int>(0, coresCount - 2)(engine);
+                remember(id);
+                pinnedCoreOf[id] = to < core ? to : to + 1;
+                break;
+            }
+            case Move::Reordering: {
+                // Only makes a difference if the Task was ready by then
+                const auto& timeline = planningStuff.processors[planningStuff.assignmentOf[id].first].processingTimeline;
+                const auto it = std::find_if(timeline.begin(), timeline.end(),
+                        [id](const auto& event){ return event.taskId == id; });
+                if (it == timeline.begin()) continue;
+                const int before = std::prev(it)->taskId;
+                const auto& priorityOf = planningStuff.workspace.priorityOf;
+                if (priorityOf[id] < priorityOf[before]) continue;
+                remember(id);
+                priorityBiasOf[id] += priorityOf[before] - priorityOf[id] - 1;
+                break;
+            }
+        }
+        search.moves++;
+
+        replanning(taskGraph, compactTaskGraph, rootTaskIndices, coresCount, planningStuff);
+        const int movedMakespan = planningStuff.finishedAt();
+        const int movedEnergy = plannedEnergy(taskGraph, compactTaskGraph, planningStuff);
+        if (betterPlanning(makespan, energy, movedMakespan, movedEnergy, desiredTime)) {
+            for (auto it = undo.rbegin(); it != undo.rend(); it++) {
+                const auto [changedId, oldPolicy, oldPinnedCore, oldPriorityBias] = *it;
+                if (taskGraph.tasks[changedId].policy != oldPolicy) setPolicy(changedId, oldPolicy);
+                pinnedCoreOf[changedId] = oldPinnedCore;
+                priorityBiasOf[changedId] = oldPriorityBias;
+            }
+            copyPlanning(accepted, planningStuff);
+            continue;
+        }
+        copyPlanning(planningStuff, accepted);
+        search.accepted++;
+        makespan = movedMakespan;
+        energy = movedEnergy;
+        if (!betterPlanning(makespan, energy, search.makespan, search.energy, desiredTime)) continue;
+        search.improvements++;
+        search.makespan = makespan;
+        search.energy = energy;
+        for (int task = 0; task < tasksCount; task++) bestPolicies[task] = taskGraph.tasks[task].policy;
+        bestPinnedCoreOf = pinnedCoreOf;
+        bestPriorityBiasOf = priorityBiasOf;
+        if (trace) trace->sample("anytime", search.moves, makespan, energy);
+    }
+
+    // Back to the best, replayed from wherever it differs from the current planning
+    for (int id = 0; id < tasksCount; id++) taskGraph.tasks[id].policy = bestPolicies[id];
+    criticalPathTracker.recalculate();
+    pinnedCoreOf.swap(bestPinnedCoreOf);
+    priorityBiasOf.swap(bestPriorityBiasOf);
+    replanning(taskGraph, compactTaskGraph, rootTaskIndices, coresCount, planningStuff);
+    schedulers = searchedFrom;
+    planningStuff.makespanOf = makespanOf;
+    search.elapsedMs = elapsedMs();
+    return search;
+}
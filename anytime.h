@@ -0,0 +1,35 @@
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include "taskGraph.h"
+#include "criticalPath.h"
+#include "planning.h"
+
+
+struct AnytimeBudget {
+    double milliseconds = 100.0; // from the given start, so it may cover what ran before the search
+    int moves = 1000000; // drawn, whether or not they apply
+    unsigned int seed = 302;
+    const std::atomic<bool>* cancelled = nullptr; // the search stops once it is set, if any
+};
+
+struct AnytimeSearch {
+    int startMakespan = 0, startEnergy = 0; // of the planning the search started from
+    int makespan = 0, energy = 0; // of the best planning found
+    int moves = 0; // tried, i.e. drawn and applied
+    int accepted = 0; // kept, as they were no worse
+    int improvements = 0; // on the best so far
+    bool cancelled = false;
+    double elapsedMs = 0.0; // since the start of the budget
+};
+
+// Meeting the desired time first, then by energy if both meet it, else by makespan
+bool betterPlanning(int makespan, int energy, int otherMakespan, int otherEnergy, int desiredTime) noexcept;
+
+// Local search over policy changes, core migrations and swaps of neighbours on
+// a core, keeping every move that is no worse. Leaves the best planning found.
+AnytimeSearch searchPlanning(TaskGraph& taskGraph, CriticalPathTracker& criticalPathTracker,
+        const std::vector<int>& rootTaskIndices, int desiredTime, int coresCount, PlanningStuff& planningStuff,
+        const AnytimeBudget& budget, std::chrono::steady_clock::time_point start);
@@ -0,0 +1,329 @@
+// Solves a batch of instances without any drawing, one JSON line per
+// instance and core count. An instance is a task graph file (text or binary)
+// or a generator spec (see generateTaskGraph()).
+//
+// ./batch [--cores 2,4] [--deadline T] [--list file] [--output file]
+//         [--threads N] [--report file] [--speedup path|cut|cheapest]
+//         [--optimize-energy ms] [--energy-iterations N]
+//         [--network ideal|bus|crossbar|ring|mesh[:bandwidth[xCount],...]]
+//         [--profiles speed:energy[xCount],...] [--scheduler delta|heft|peft,...|best]
+//         [--trace file] [--trace-format chrome|csv] [--anytime ms] [--anytime-moves N] instance...
+// ./batch --to-binary graph.txt graph.eapg
+// ./batch --to-text graph.eapg graph.txt
+//
+// A file has no desired time of its own, so it is --deadline, or else halfway
+// between the critical times on the fastest and on the slowest policies.
+//
+// The instances are solved on --threads workers (0 for one per hardware
+// thread) with work stealing, and the lines come out in the order of the
+// instances whatever the number of threads. --report writes how the work
+// was spread over the workers, as JSON.
+//
+// --speedup cut speeds up a minimum cut of the critical paths per step
+// instead of one Task of one of them, cheapest the critical Task that adds the
+// least energy per unit of time saved (see SpeedupMode). --optimize-energy
+// then runs minimizeEnergy() for up to that long (and --energy-iterations),
+// and the line gets the energy of both and the bound. --network plans the
+// transfers on the links of that topology instead of without contention,
+// with the bandwidths of the links in order (see NetworkModel).
+// --profiles makes the first cores faster or slower than the nominal one, and
+// more or less power hungry, in percent (see CoreProfile), e.g. 150:180x2,60:40x2
+// for two big and two little cores. --scheduler plans with each of those (see
+// Scheduler) and keeps the least makespan, best being all of them.
+// --trace writes where the time of every instance went (see Trace): its
+// stages, counters and the critical time and energy of every iteration, as a
+// Chrome trace (chrome://tracing, Perfetto) or CSV, with a thread per worker.
+// --anytime searches the planning of every instance and core count (see
+// searchPlanning()) until that long after its solve started (and at most
+// --anytime-moves moves drawn), and the line gets the best planning found,
+// with the moves that applied. An interrupt (Ctrl-C) cuts the searches
+// short, and the lines still come out.
+// --to-binary and --to-text convert a task graph file between the text and
+// the binary formats instead, solving nothing.
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <optional>
+#include <variant>
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <csignal>
+#include <sys/stat.h>
+#include "taskGraph.h"
+#include "taskGraphIO.h"
+#include "generators.h"
+#include "solver.h"
+#include "workStealing.h"
+
+
+template<typename T>
+std::optional<T> parseNumber(std::string_view text) {
+    T value;
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error != std::errc() || end != text.data() + text.size()) return std::nullopt;
+    return { value };
+}
+
+std::optional<std::vector<int>> parsePositiveList(std::string_view list) {
+    std::vector<int> values;
+    while (true) {
+        const auto comma = list.find(',');
+        const auto value = parseNumber<int>(list.substr(0, comma));
+        if (!value || *value <= 0) return std::nullopt;
+        values.push_back(*value);
+        if (comma == std::string_view::npos) return { values };
+        list.remove_prefix(comma + 1);
+    }
+}
+
+// Set on an interrupt, which then only cuts the anytime searches short
+std::atomic<bool> interrupted{ false };
+
+void interrupt(int) {
+    interrupted.store(true);
+}
+
+bool fileExists(const std::string& path) {
+    struct stat info;
+    return stat(path.c_str(), &info) == 0;
+}
+
+// Every core count of one instance. False if the instance could not be solved.
+bool solveInstance(const std::string& instance, const std::vector<int>& coresCounts, std::optional<int> deadline,
+        const SolverOptions& options, SolverWorkspace& workspace, std::ostream& os, std::ostream& log, Trace* trace) {
+    std::optional<TaskGraph> taskGraph;
+    std::optional<CompactTaskGraph> compactTaskGraph; // a binary file, solved as it is mapped
+    int desiredTime;
+    if (fileExists(instance)) {
+        ParseError error;
+        auto loaded = loadTaskGraph(instance, error);
+        if (!loaded) {
+            std::ostringstream message;
+            message << error;
+            writeErrorJson(os, instance, message.str());
+            return false;
+        }
+        if (auto* text = std::get_if<TaskGraph>(&*loaded)) taskGraph = std::move(*text);
+        else compactTaskGraph = std::move(std::get<CompactTaskGraph>(*loaded));
+        // A cycle is left for solve() to report
+        if (deadline) {
+            desiredTime = *deadline;
+        } else if (taskGraph) {
+            const bool acyclic = getTopologicalOrder(*taskGraph).size() == taskGraph->tasks.size();
+            desiredTime = acyclic ? getDesiredTime(*taskGraph) : 0;
+        } else {
+            const bool acyclic = static_cast<int>(getTopologicalOrder(*compactTaskGraph).size())
+                == compactTaskGraph->tasksCount;
+            desiredTime = acyclic ? getDesiredTime(*compactTaskGraph) : 0;
+        }
+    } else if (auto generated = generateTaskGraph(instance)) {
+        taskGraph = std::move(generated->first);
+        desiredTime = deadline ? *deadline : generated->second;
+    } else {
+        writeErrorJson(os, instance, "Neither a task graph file nor a generator spec.");
+        return false;
+    }
+
+    bool solved = true;
+    for (int cores : coresCounts) {
+        const Solution solution = taskGraph
+            ? solve(*taskGraph, desiredTime, cores, workspace, log, options, trace)
+            : solve(*compactTaskGraph, desiredTime, cores, workspace, log, options, trace);
+        writeSolutionJson(os, instance, cores, desiredTime, taskGraph ? *taskGraph : workspace.blankTaskGraph,
+                workspace.planningStuff, solution);
+        solved = solved && solution.acyclic;
+    }
+    return solved;
+}
+
+void writeReportJson(std::ostream& os, int instancesCount, double wallMs, const std::vector<WorkerReport>& reports) {
+    double busyMs = 0.0;
+    for (const auto& report : reports) busyMs += report.busyMs;
+    os << "{\"threads\": " << reports.size() << ", \"instances\": " << instancesCount
+        << ", \"wall_ms\": " << wallMs << ", \"busy_ms\": " << busyMs
+        << ", \"speedup\": " << (wallMs > 0.0 ? busyMs / wallMs : 0.0)
+        << ", \"instances_per_second\": " << (wallMs > 0.0 ? instancesCount * 1000.0 / wallMs : 0.0)
+        << ", \"workers\": [";
+    for (unsigned int worker = 0; worker < reports.size(); worker++) {
+        const auto& report = reports[worker];
+        os << (worker ? ", " : "") << "{\"instances\": " << report.tasksRun << ", \"stolen\": " << report.tasksStolen
+            << ", \"busy_ms\": " << report.busyMs
+            << ", \"utilization\": " << (wallMs > 0.0 ? report.busyMs / wallMs : 0.0) << "}";
+    }
+    os << "]}\n";
+}
+
+int main(int argc, char* argv[]) {
+    // Conversion between the text and the binary task graph formats
+    if (argc == 4 && std::string_view(argv[1]) == "--to-binary") return convertToBinary(argv[2], argv[3]) ? 0 : -1;
+    if (argc == 4 && std::string_view(argv[1]) == "--to-text") return convertToText(argv[2], argv[3]) ? 0 : -1;
+
+    std::vector<int> coresCounts{ 3 };
+    std::optional<int> deadline;
+    std::string_view outputPath;
+    std::string_view reportPath;
+    std::string_view tracePath;
+    TraceFormat traceFormat = TraceFormat::Chrome;
+    int threadsCount = 1;
+    SolverOptions options;
+    EnergyBudget energyBudget;
+    AnytimeBudget anytimeBudget;
+    anytimeBudget.cancelled = &interrupted;
+    std::vector<std::string> instances;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string_view option = argv[i];
+        if (option.rfind("--", 0) != 0) {
+            instances.emplace_back(option);
+            continue;
+        }
+        if (i + 1 == argc) {
+            std::cout << "::> Expected a value after " << option << '\n';
+            return -1;
+        }
+        const std::string_view value = argv[++i];
+        bool valid = true;
+        if (option == "--cores") {
+            const auto values = parsePositiveList(value);
+            if ((valid = values.has_value())) coresCounts = *values;
+        } else if (option == "--deadline") {
+            deadline = parseNumber<int>(value);
+            valid = deadline.has_value();
+        } else if (option == "--list") {
+            std::ifstream list{std::string(value)};
+            valid = static_cast<bool>(list);
+            std::string line;
+            while (std::getline(list, line)) {
+                if (!line.empty() && line.front() != '#') instances.push_back(line);
+            }
+        } else if (option == "--output") {
+            outputPath = value;
+        } else if (option == "--report") {
+            reportPath = value;
+        } else if (option == "--trace") {
+            tracePath = value;
+        } else if (option == "--trace-format") {
+            const auto format = parseTraceFormat(value);
+            if ((valid = format.has_value())) traceFormat = *format;
+        } else if (option == "--threads") {
+            const auto threads = parseNumber<int>(value);
+            if ((valid = threads && *threads >= 0)) {
+                threadsCount = *threads ? *threads : std::max(1u, std::thread::hardware_concurrency());
+            }
+        } else if (option == "--speedup") {
+            const auto mode = parseSpeedupMode(value);
+            if ((valid = mode.has_value())) options.speedupMode = *mode;
+        } else if (option == "--network") {
+            const auto network = parseNetworkModel(value);
+            if ((valid = network.has_value())) options.network = *network;
+        } else if (option == "--profiles") {
+            const auto profiles = parseCoreProfiles(value);
+            if ((valid = profiles.has_value())) options.coreProfiles = *profiles;
+        } else if (option == "--scheduler") {
+            const auto schedulers = parseSchedulers(value);
+            if ((valid = schedulers.has_value())) options.schedulers = *schedulers;
+        } else if (option == "--optimize-energy") {
+            const auto milliseconds = parseNumber<int>(value);
+            if ((valid = milliseconds && *milliseconds >= 0)) {
+                energyBudget.milliseconds = *milliseconds;
+                options.energyBudget = energyBudget;
+            }
+        } else if (option == "--energy-iterations") {
+            const auto iterations = parseNumber<int>(value);
+            if ((valid = iterations && *iterations > 0)) {
+                energyBudget.iterations = *iterations;
+                options.energyBudget = energyBudget;
+            }
+        } else if (option == "--anytime") {
+            const auto milliseconds = parseNumber<int>(value);
+            if ((valid = milliseconds && *milliseconds >= 0)) {
+                anytimeBudget.milliseconds = *milliseconds;
+                options.anytimeBudget = anytimeBudget;
+            }
+        } else if (option == "--anytime-moves") {
+            const auto moves = parseNumber<int>(value);
+            if ((valid = moves && *moves > 0)) {
+                anytimeBudget.moves = *moves;
+                options.anytimeBudget = anytimeBudget;
+            }
+        } else {
+            std::cout << "::> Unknown option " << option << '\n';
+            return -1;
+        }
+        if (!valid) {
+            std::cout << "::> Invalid value for " << option << ": " << value << '\n';
+            return -1;
+        }
+    }
+    if (instances.empty()) {
+        std::cout << "::> No instances to solve.\n";
+        return -1;
+    }
+
+    std::ofstream outputFile;
+    if (!outputPath.empty()) {
+        outputFile.open(std::string(outputPath));
+        if (!outputFile) {
+            std::cout << "::> Could not write " << outputPath << '\n';
+            return -1;
+        }
+    }
+    std::ostream& os = outputPath.empty() ? std::cout : outputFile;
+    if (options.anytimeBudget) std::signal(SIGINT, interrupt);
+
+    // Every worker has its own buffers, and every instance its own output
+    struct WorkerScratch {
+        SolverWorkspace workspace;
+        std::ostream nullLog{nullptr};
+    };
+    const int instancesCount = instances.size();
+    threadsCount = std::min(threadsCount, instancesCount);
+    std::vector<WorkerScratch> scratches(threadsCount);
+    std::vector<std::string> outputs(instancesCount);
+    std::vector<char> solved(instancesCount, false);
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<Trace> traces(tracePath.empty() ? 0 : instancesCount, Trace(start));
+    for (unsigned int instance = 0; instance < traces.size(); instance++) traces[instance].label = instances[instance];
+    const auto reports = runWorkStealing(instancesCount, threadsCount,
+            [&](int instance, int worker){
+        auto& scratch = scratches[worker];
+        std::ostringstream output;
+        Trace* const trace = traces.empty() ? nullptr : &traces[instance];
+        if (trace) trace->thread = worker;
+        solved[instance] = solveInstance(instances[instance], coresCounts, deadline, options,
+                scratch.workspace, output, scratch.nullLog, trace);
+        outputs[instance] = output.str();
+    });
+    const auto finish = std::chrono::steady_clock::now();
+
+    for (const auto& output : outputs) os << output;
+    os.flush();
+
+    if (!reportPath.empty()) {
+        std::ofstream reportFile{std::string(reportPath)};
+        writeReportJson(reportFile, instancesCount,
+                std::chrono::duration<double, std::milli>(finish - start).count(), reports);
+        if (!reportFile) {
+            std::cout << "::> Could not write " << reportPath << '\n';
+            return -1;
+        }
+    }
+
+    if (!tracePath.empty()) {
+        std::ofstream traceFile{std::string(tracePath)};
+        writeTraces(traceFile, traces, traceFormat);
+        if (!traceFile) {
+            std::cout << "::> Could not write " << tracePath << '\n';
+            return -1;
+        }
+    }
+
+    const bool allSolved = std::all_of(solved.begin(), solved.end(), [](char s){ return s; });
+    return allSolved ? 0 : -1;
+}
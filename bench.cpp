@@ -0,0 +1,440 @@
+// Benchmark of the pipeline stages, without any drawing.
+// Every stage is run on its own over a sweep of instances and reported with its
+// wall time, the allocations made in it and the peak resident set size,
+// so that the results of several runs can be compared as curves.
+// The parse stages also report the size of the text and their throughput in
+// MB/s: parse is parseTaskGraph() and parse_stream the reader it replaced, a
+// token at a time through a stream, kept here as the reference.
+// The warm stages run their stage again into the storage it has grown to the
+// instance, from the same state, so the solver loops should allocate nothing:
+// voltage_lowering_warm speeds the critical path up again from the slowest
+// policies, planning_warm plans again and improvement_warm improves the
+// planning again from the policies it started from.
+//
+// ./bench [--n 100,200] [--connectivity 0.1,0.3] [--policies 2,4] [--cores 2,4]
+//         [--repeat 3] [--seed 302] [--format csv|json] [--output file]
+//         [--speedup path|cut|cheapest] [--network ideal|bus|crossbar|ring|mesh[:bandwidth[xCount],...]]
+//         [--scheduler delta|heft|peft,...|best]
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <optional>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <sys/resource.h>
+#include "taskGraph.h"
+#include "taskGraphIO.h"
+#include "criticalPath.h"
+#include "generators.h"
+#include "planning.h"
+
+
+// Every allocation of the program goes through here, so a stage is charged
+// with exactly what it allocates
+struct AllocationCounter {
+    long long allocations = 0;
+    long long bytes = 0;
+};
+static AllocationCounter allocationCounter;
+
+// GCC sees the std::free() of memory from operator new, not that both are replaced here
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+void* operator new(std::size_t size) {
+    allocationCounter.allocations++;
+    allocationCounter.bytes += size;
+    if (void* pointer = std::malloc(size ? size : 1)) return pointer;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+
+// The peak resident set size is reset before every stage where the kernel
+// allows it (clear_refs), otherwise it is the peak of the whole process so far
+bool resetPeakRss() {
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";
+    clearRefs.flush();
+    return static_cast<bool>(clearRefs);
+}
+
+long peakRssKb() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmHWM:", 0) == 0) return std::atol(line.c_str() + 6);
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+struct StageResult {
+    std::string stage;
+    std::vector<double> wallMs; // one per repetition
+    long long allocations = 0, allocatedBytes = 0; // of the last repetition
+    long peakRssKb = 0; // the max over the repetitions
+    long long inputBytes = 0; // read by the stage, if it reads any
+
+    explicit StageResult(std::string&& stage) : stage(std::move(stage)) {}
+
+    double medianWallMs() const {
+        std::vector<double> sorted(wallMs);
+        std::sort(sorted.begin(), sorted.end());
+        return sorted[sorted.size() / 2];
+    }
+    double minWallMs() const { return *std::min_element(wallMs.begin(), wallMs.end()); }
+    // Of the median repetition, in millions of bytes per second
+    double megabytesPerSecond() const { return inputBytes / medianWallMs() / 1e3; }
+};
+
+struct StageMeter {
+    StageResult& result;
+    const AllocationCounter before;
+    const std::chrono::steady_clock::time_point start;
+
+    explicit StageMeter(StageResult& result)
+        : result(result), before((resetPeakRss(), allocationCounter)), start(std::chrono::steady_clock::now()) {}
+    ~StageMeter() {
+        const auto finish = std::chrono::steady_clock::now();
+        // Read before the wall time is stored, which may allocate too
+        result.allocations = allocationCounter.allocations - before.allocations;
+        result.allocatedBytes = allocationCounter.bytes - before.bytes;
+        result.wallMs.push_back(std::chrono::duration<double, std::milli>(finish - start).count());
+        result.peakRssKb = std::max(result.peakRssKb, peakRssKb());
+    }
+};
+
+// The reader of the task graph text before parseTaskGraph(): token by token
+// through a stream, linking every transfer as it comes
+std::optional<TaskGraph> readTaskGraphByStream(std::istream& stream) {
+    char type;
+    unsigned int voltageLevelsAmount;
+    if (!(stream >> type) || type != 'V' || !(stream >> voltageLevelsAmount)) return std::nullopt;
+    if (!(stream >> type) || type != 'I' || !(stream >> type) || (type != '0' && type != '1')) return std::nullopt;
+    const bool indexingFromZero = type == '0';
+
+    TaskGraph taskGraph(indexingFromZero);
+    taskGraph.policiesCount = voltageLevelsAmount;
+    int expectedId = indexingFromZero ? 0 : 1;
+    while (stream >> type) {
+        if (type == 'T') {
+            int id;
+            std::vector<int> weights(voltageLevelsAmount);
+            std::vector<int> energies(voltageLevelsAmount);
+            stream >> id >> type;
+            if (expectedId != id) return std::nullopt;
+            expectedId++;
+            for (unsigned int i = 0; i < voltageLevelsAmount; i++) stream >> weights[i];
+            stream >> type;
+            for (unsigned int i = 0; i < voltageLevelsAmount; i++) stream >> energies[i];
+            taskGraph.add(std::move(weights), std::move(energies));
+        } else if (type == 'S') {
+            int from, to, volume;
+            stream >> from >> type >> to >> type >> volume;
+            if (!indexingFromZero) { from--; to--; }
+            taskGraph.addTransfer(from, to, volume);
+        } else {
+            return std::nullopt;
+        }
+    }
+    return { taskGraph };
+}
+
+struct Instance {
+    int N;
+    float connectivity;
+    int policies;
+    int cores;
+};
+
+// The stages of main, one after another, on the text of a task graph.
+// Every repetition starts over from the text. None, with the error, if the
+// graph cannot be read or has cycles.
+std::optional<std::vector<StageResult>> runPipeline(const std::string& text, int desiredTime, int cores, int repeat,
+        SpeedupMode speedupMode, const NetworkModel& network, const std::vector<Scheduler>& schedulers,
+        std::string& error) {
+    std::vector<StageResult> results;
+    for (const char* stage : { "parse", "parse_stream", "cycle_check", "recalculate_stats", "voltage_lowering", "voltage_lowering_warm",
+            "planning", "planning_warm", "improvement", "improvement_warm" }) {
+        results.emplace_back(stage);
+    }
+    results[0].inputBytes = results[1].inputBytes = text.size();
+    for (int repetition = 0; repetition < repeat; repetition++) {
+        std::optional<TaskGraph> taskGraph;
+        {
+            const StageMeter meter(results[0]);
+            ParseError error;
+            taskGraph = parseTaskGraph(text.data(), text.data() + text.size(), error);
+        }
+        if (!taskGraph) {
+            error = "Could not parse a generated task graph.";
+            return std::nullopt;
+        }
+        {
+            // Filled outside of the stage, as the text already is for parse
+            std::istringstream stream(text);
+            std::optional<TaskGraph> streamedTaskGraph;
+            {
+                const StageMeter meter(results[1]);
+                streamedTaskGraph = readTaskGraphByStream(stream);
+            }
+            if (!streamedTaskGraph) {
+                error = "Could not read a generated task graph through a stream.";
+                return std::nullopt;
+            }
+        }
+
+        std::vector<int> rootTaskIndices;
+        std::vector<int> topologicalOrder;
+        {
+            const StageMeter meter(results[2]);
+            rootTaskIndices = getRootTasks(*taskGraph);
+            topologicalOrder = getTopologicalOrder(*taskGraph);
+            if (findCycle(*taskGraph, topologicalOrder)) {
+                error = "Cycles detected in a generated task graph.";
+                return std::nullopt;
+            }
+        }
+
+        const CompactTaskGraph compactTaskGraph(*taskGraph);
+        const int policiesCount = compactTaskGraph.policiesCount;
+        for (auto& task : taskGraph->tasks) task.policy = policiesCount - 1;
+        {
+            const StageMeter meter(results[3]);
+            recalculateStats(*taskGraph, compactTaskGraph, rootTaskIndices, topologicalOrder);
+        }
+
+        std::optional<CriticalPathTracker> criticalPathTracker;
+        SpeedupWorkspace speedupWorkspace;
+        {
+            const StageMeter meter(results[4]);
+            criticalPathTracker.emplace(*taskGraph, compactTaskGraph, rootTaskIndices, topologicalOrder);
+            speedupCriticalPath(*taskGraph, *criticalPathTracker, desiredTime, speedupMode, speedupWorkspace);
+        }
+
+        for (auto& task : taskGraph->tasks) task.policy = policiesCount - 1;
+        criticalPathTracker->recalculate();
+        {
+            const StageMeter meter(results[5]);
+            speedupCriticalPath(*taskGraph, *criticalPathTracker, desiredTime, speedupMode, speedupWorkspace);
+        }
+
+        std::optional<PlanningStuff> planningStuff;
+        {
+            const StageMeter meter(results[6]);
+            planningStuff.emplace();
+            planningStuff->network.model = network;
+            planningStuff->schedulers = schedulers;
+            planning(*taskGraph, compactTaskGraph, rootTaskIndices, cores, *planningStuff);
+        }
+
+        {
+            const StageMeter meter(results[7]);
+            planning(*taskGraph, compactTaskGraph, rootTaskIndices, cores, *planningStuff);
+        }
+
+        std::vector<int> policies(taskGraph->tasks.size());
+        for (unsigned int id = 0; id < policies.size(); id++) policies[id] = taskGraph->tasks[id].policy;
+        std::optional<PlanningStuff> improvedPlanningStuff;
+        {
+            const StageMeter meter(results[8]);
+            improvedPlanningStuff.emplace();
+            improvedPlanningStuff->network.model = network;
+            improvedPlanningStuff->schedulers = schedulers;
+            improvePlanning(*taskGraph, compactTaskGraph, *criticalPathTracker,
+                    rootTaskIndices, desiredTime, cores, *improvedPlanningStuff);
+        }
+
+        for (unsigned int id = 0; id < policies.size(); id++) taskGraph->tasks[id].policy = policies[id];
+        criticalPathTracker->recalculate();
+        {
+            const StageMeter meter(results[9]);
+            improvePlanning(*taskGraph, compactTaskGraph, *criticalPathTracker,
+                    rootTaskIndices, desiredTime, cores, *improvedPlanningStuff);
+        }
+    }
+    return results;
+}
+
+void printCsvHeader(std::ostream& os) {
+    os << "N,connectivity,policies,cores,tasks,transfers,stage,"
+        "wall_ms,wall_ms_min,allocations,allocated_bytes,peak_rss_kb,input_bytes,mb_per_s\n";
+}
+
+void printCsv(std::ostream& os, const Instance& instance, int tasks, int transfers, const StageResult& result) {
+    os << instance.N << ',' << instance.connectivity << ',' << instance.policies << ',' << instance.cores << ','
+        << tasks << ',' << transfers << ',' << result.stage << ','
+        << result.medianWallMs() << ',' << result.minWallMs() << ','
+        << result.allocations << ',' << result.allocatedBytes << ',' << result.peakRssKb << ','
+        << result.inputBytes << ',';
+    if (result.inputBytes > 0) os << result.megabytesPerSecond();
+    os << '\n';
+}
+
+void printJson(std::ostream& os, const Instance& instance, int tasks, int transfers, const StageResult& result) {
+    os << "{\"N\": " << instance.N << ", \"connectivity\": " << instance.connectivity
+        << ", \"policies\": " << instance.policies << ", \"cores\": " << instance.cores
+        << ", \"tasks\": " << tasks << ", \"transfers\": " << transfers
+        << ", \"stage\": \"" << result.stage << "\""
+        << ", \"wall_ms\": " << result.medianWallMs() << ", \"wall_ms_min\": " << result.minWallMs()
+        << ", \"allocations\": " << result.allocations << ", \"allocated_bytes\": " << result.allocatedBytes
+        << ", \"peak_rss_kb\": " << result.peakRssKb << ", \"input_bytes\": " << result.inputBytes
+        << ", \"mb_per_s\": ";
+    if (result.inputBytes > 0) os << result.megabytesPerSecond();
+    else os << "null";
+    os << "}";
+}
+
+template<typename T>
+std::optional<std::vector<T>> parseList(std::string_view list) {
+    std::vector<T> values;
+    std::istringstream stream{std::string(list)};
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        std::istringstream itemStream(item);
+        T value;
+        if (!(itemStream >> value) || !itemStream.eof()) return std::nullopt;
+        values.push_back(value);
+    }
+    if (values.empty()) return std::nullopt;
+    return { values };
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<int> Ns{ 100, 200, 400, 800 };
+    std::vector<float> connectivities{ 0.05f, 0.2f };
+    std::vector<int> policiesCounts{ 2, 4 };
+    std::vector<int> coresCounts{ 2, 4 };
+    int repeat = 3;
+    unsigned int seed = 302;
+    std::string_view format = "csv";
+    std::string_view outputPath;
+    SpeedupMode speedupMode = SpeedupMode::FirstOnPath;
+    NetworkModel network;
+    std::vector<Scheduler> schedulers{ Scheduler::Delta };
+
+    for (int i = 1; i < argc; i++) {
+        const std::string_view option = argv[i];
+        if (i + 1 == argc) {
+            std::cout << "::> Expected a value after " << option << '\n';
+            return -1;
+        }
+        const std::string_view value = argv[++i];
+        bool valid = true;
+        if (option == "--n") {
+            const auto values = parseList<int>(value);
+            if ((valid = values.has_value())) Ns = *values;
+        } else if (option == "--connectivity") {
+            const auto values = parseList<float>(value);
+            if ((valid = values.has_value())) connectivities = *values;
+        } else if (option == "--policies") {
+            const auto values = parseList<int>(value);
+            if ((valid = values.has_value())) policiesCounts = *values;
+        } else if (option == "--cores") {
+            const auto values = parseList<int>(value);
+            if ((valid = values.has_value())) coresCounts = *values;
+        } else if (option == "--repeat") {
+            const auto values = parseList<int>(value);
+            if ((valid = values && values->size() == 1 && values->front() > 0)) repeat = values->front();
+        } else if (option == "--seed") {
+            const auto values = parseList<unsigned int>(value);
+            if ((valid = values && values->size() == 1)) seed = values->front();
+        } else if (option == "--format") {
+            valid = value == "csv" || value == "json";
+            format = value;
+        } else if (option == "--output") {
+            outputPath = value;
+        } else if (option == "--network") {
+            const auto model = parseNetworkModel(value);
+            if ((valid = model.has_value())) network = *model;
+        } else if (option == "--speedup") {
+            const auto mode = parseSpeedupMode(value);
+            if ((valid = mode.has_value())) speedupMode = *mode;
+        } else if (option == "--scheduler") {
+            const auto values = parseSchedulers(value);
+            if ((valid = values.has_value())) schedulers = *values;
+        } else {
+            std::cout << "::> Unknown option " << option << '\n';
+            return -1;
+        }
+        if (!valid) {
+            std::cout << "::> Invalid value for " << option << ": " << value << '\n';
+            return -1;
+        }
+    }
+
+    std::ofstream outputFile;
+    if (!outputPath.empty()) {
+        outputFile.open(std::string(outputPath));
+        if (!outputFile) {
+            std::cout << "::> Could not write " << outputPath << '\n';
+            return -1;
+        }
+    }
+    std::ostream& os = outputPath.empty() ? std::cout : outputFile;
+
+    const bool json = format == "json";
+    if (json) os << "[\n";
+    else printCsvHeader(os);
+    bool first = true;
+    std::string error;
+    // False on the first instance that fails, whose error is then printed once
+    // the output is closed
+    const auto sweep = [&](){
+        for (int N : Ns) {
+            for (float connectivity : connectivities) {
+                for (int policies : policiesCounts) {
+                    // The same instance whatever else is in the sweep
+                    std::mt19937 engine(seed);
+                    const int lowTime = 3, highTime = 10;
+                    const int lowVolume = 1, highVolume = 3;
+                    const auto [taskGraph, desiredTime] = generateRandomTaskGraph(N, policies, connectivity,
+                            lowTime, highTime, lowVolume, highVolume, engine);
+                    std::ostringstream text;
+                    writeTaskGraph(text, taskGraph);
+
+                    for (int cores : coresCounts) {
+                        const Instance instance{ N, connectivity, policies, cores };
+                        const auto results = runPipeline(text.str(), desiredTime, cores, repeat, speedupMode, network,
+                                schedulers, error);
+                        if (!results) return false;
+                        for (const auto& result : *results) {
+                            const int tasks = taskGraph.tasks.size(), transfers = taskGraph.transfers.size();
+                            if (json) {
+                                if (!first) os << ",\n";
+                                printJson(os, instance, tasks, transfers, result);
+                            } else {
+                                printCsv(os, instance, tasks, transfers, result);
+                            }
+                            first = false;
+                        }
+                        os.flush();
+                    }
+                }
+            }
+        }
+        return true;
+    };
+    const bool done = sweep();
+    if (json) os << "\n]\n";
+    os.flush();
+    if (!done) {
+        std::cout << "::> " << error << '\n';
+        return -1;
+    }
+
+    return 0;
+}
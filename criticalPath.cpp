@@ -0,0 +1,200 @@
+#include "criticalPath.h"
+
+#include <limits>
+#include <stdexcept>
+
+
+void recalculateEarlyLate(TaskGraph& taskGraph, const CompactTaskGraph& compactTaskGraph,
+        const std::vector<int>& topologicalOrder) {
+    const auto weightOf = [&taskGraph, &compactTaskGraph](int id){
+        return compactTaskGraph.weight(id, taskGraph.tasks[id].policy);
+    };
+    for (int id : topologicalOrder) {
+        int early = 0;
+        for (const auto& [parent, _volume] : compactTaskGraph.predecessorsOf(id)) {
+            const int parentFinish = *taskGraph.tasks[parent].early + weightOf(parent);
+            if (parentFinish > early) early = parentFinish;
+        }
+        taskGraph.tasks[id].early = { early };
+    }
+
+    for (auto it = topologicalOrder.rbegin(); it != topologicalOrder.rend(); it++) {
+        int min = 0; // find max cumulative time, but treat as min because they are stored negative
+        for (const auto& [dst, _volume] : compactTaskGraph.successorsOf(*it)) {
+            const int targetLate = *taskGraph.tasks[dst].late;
+            if (targetLate < min) min = targetLate;
+        }
+        taskGraph.tasks[*it].late = { min - weightOf(*it) };
+    }
+}
+
+std::vector<int> getCriticalPathFrom(int rootId, const TaskGraph& taskGraph, const CompactTaskGraph& compactTaskGraph) {
+    std::vector<int> criticalPath;
+    getCriticalPathFrom(rootId, taskGraph, compactTaskGraph, criticalPath);
+    return criticalPath;
+}
+
+void getCriticalPathFrom(int rootId, const TaskGraph& taskGraph, const CompactTaskGraph& compactTaskGraph,
+        std::vector<int>& criticalPath) {
+    criticalPath.clear();
+    int currId = rootId;
+    while (!compactTaskGraph.successorsOf(currId).empty()) {
+        const auto& curr = taskGraph.tasks[currId];
+        criticalPath.push_back(currId);
+        const int expectedTargetLate = *curr.late + compactTaskGraph.weight(currId, curr.policy);
+        bool found = false;
+        for (const auto& [id, _] : compactTaskGraph.successorsOf(currId)) {
+            if (*taskGraph.tasks[id].late == expectedTargetLate) {
+                currId = id;
+                found = true;
+                break;
+            }
+        }
+        if (!found) throw std::logic_error("getCriticalPathFrom(): the Late of the Tasks is out of date");
+    }
+    criticalPath.push_back(currId);
+}
+
+std::pair<std::vector<int>, int> recalculateStats(TaskGraph& taskGraph, const CompactTaskGraph& compactTaskGraph,
+        const std::vector<int>& rootTaskIndices, const std::vector<int>& topologicalOrder) {
+    recalculateEarlyLate(taskGraph, compactTaskGraph, topologicalOrder);
+
+    if (rootTaskIndices.empty()) return std::make_pair(std::vector<int>(), 0); // no Tasks
+
+    int criticalTime = 0; // they are stored negative
+    int criticalPathRoot = rootTaskIndices.front(); // all may take no time
+    for (int id : rootTaskIndices) {
+        const int maybeCriticalTime = *taskGraph.tasks[id].late;
+        if (maybeCriticalTime < criticalTime) {
+            criticalTime = maybeCriticalTime;
+            criticalPathRoot = id;
+        }
+    }
+
+    return std::make_pair(getCriticalPathFrom(criticalPathRoot, taskGraph, compactTaskGraph), -criticalTime);
+}
+
+std::optional<int> findTaskToSpeedup(const std::vector<int>& path, const TaskGraph& taskGraph) {
+    // Find the first Task with 'INCable' policy
+    for (int id : path) {
+        if (taskGraph.tasks[id].policy > 0) return { id };
+    }
+    return std::nullopt;
+}
+
+// A minimum cut of the zero-slack subgraph, every Task split into an in and an out node
+void findCriticalCut(const TaskGraph& taskGraph, const CompactTaskGraph& compactTaskGraph,
+        int criticalTime, MaxFlow& maxFlow, std::vector<int>& nodeOf, std::vector<int>& cut) {
+    // The critical Tasks get the nodes 2 + 2i (in) and 3 + 2i (out)
+    const int source = 0, sink = 1;
+    const int tasksCount = taskGraph.tasks.size();
+    nodeOf.assign(tasksCount, -1);
+    int criticalCount = 0;
+    for (int id = 0; id < tasksCount; id++) {
+        const auto& task = taskGraph.tasks[id];
+        if (*task.early - *task.late == criticalTime) nodeOf[id] = 2 + 2 * criticalCount++;
+    }
+
+    maxFlow.reset(2 + 2 * criticalCount);
+    const long long tieBreaker = criticalCount + 1;
+    const auto finishOf = [&taskGraph, &compactTaskGraph](int id){
+        const auto& task = taskGraph.tasks[id];
+        return *task.early + compactTaskGraph.weight(id, task.policy);
+    };
+    for (int id = 0; id < tasksCount; id++) {
+        const int in = nodeOf[id];
+        if (in == -1) continue;
+        const auto& task = taskGraph.tasks[id];
+        long long capacity = MaxFlow::UNBOUNDED;
+        if (task.canImprove()) {
+            const int energyAdded = compactTaskGraph.energy(id, task.policy - 1) - compactTaskGraph.energy(id, task.policy);
+            capacity = std::max(energyAdded, 0) * tieBreaker + 1;
+        }
+        maxFlow.addEdge(in, in + 1, capacity);
+        if (*task.early == 0) maxFlow.addEdge(source, in, MaxFlow::UNBOUNDED);
+        if (finishOf(id) == criticalTime) maxFlow.addEdge(in + 1, sink, MaxFlow::UNBOUNDED);
+        // A transfer stays on the critical paths if the Target starts as soon as the Task finishes
+        for (const auto& [dst, _volume] : compactTaskGraph.successorsOf(id)) {
+            if (nodeOf[dst] != -1 && *taskGraph.tasks[dst].early == finishOf(id)) {
+                maxFlow.addEdge(in + 1, nodeOf[dst], MaxFlow::UNBOUNDED);
+            }
+        }
+    }
+
+    cut.clear();
+    if (maxFlow.run(source, sink) >= MaxFlow::UNBOUNDED) return;
+    for (int id = 0; id < tasksCount; id++) {
+        const int in = nodeOf[id];
+        if (in != -1 && maxFlow.onSourceSide(in) && !maxFlow.onSourceSide(in + 1)) cut.push_back(id);
+    }
+}
+
+double speedupCost(const CompactTaskGraph& compactTaskGraph, int id, int policy) noexcept {
+    const int saved = compactTaskGraph.weight(id, policy) - compactTaskGraph.weight(id, policy - 1);
+    const int added = compactTaskGraph.energy(id, policy - 1) - compactTaskGraph.energy(id, policy);
+    if (saved <= 0) return std::numeric_limits<double>::infinity();
+    return static_cast<double>(added) / saved;
+}
+
+std::optional<SpeedupMode> parseSpeedupMode(std::string_view name) noexcept {
+    if (name == "path") return { SpeedupMode::FirstOnPath };
+    if (name == "cut") return { SpeedupMode::MinCut };
+    if (name == "cheapest") return { SpeedupMode::Cheapest };
+    return std::nullopt;
+}
+
+bool speedupCriticalPath(TaskGraph& taskGraph, CriticalPathTracker& criticalPathTracker,
+        int desiredTime, SpeedupMode mode) {
+    SpeedupWorkspace workspace;
+    return speedupCriticalPath(taskGraph, criticalPathTracker, desiredTime, mode, workspace);
+}
+
+bool speedupCriticalPath(TaskGraph& taskGraph, CriticalPathTracker& criticalPathTracker,
+        int desiredTime, SpeedupMode mode, SpeedupWorkspace& workspace,
+        std::chrono::steady_clock::time_point deadline) {
+    auto& [criticalPath, maxFlow, nodeOf, cut, ranking] = workspace;
+    const bool onPath = mode == SpeedupMode::FirstOnPath;
+    if (onPath) criticalPathTracker.criticalPath(criticalPath);
+    auto criticalTime = criticalPathTracker.criticalTime();
+    const auto& compactTaskGraph = criticalPathTracker.compactTaskGraph;
+    Trace* const trace = criticalPathTracker.trace;
+    int energy = 0, step = 0; // only kept up with the trace
+    if (trace) {
+        for (int id = 0; id < compactTaskGraph.tasksCount; id++) {
+            energy += compactTaskGraph.energy(id, taskGraph.tasks[id].policy);
+        }
+        trace->sample("speedup", step, criticalTime, energy);
+    }
+    const auto speedup = [&taskGraph, &criticalPathTracker, &compactTaskGraph, trace, &energy](int id){
+        auto& task = taskGraph.tasks[id];
+        task.policy--; // improve performance of this Task
+        criticalPathTracker.taskChanged(id);
+        if (!trace) return;
+        trace->count(Trace::Counter::PolicyDecrements);
+        energy += compactTaskGraph.energy(id, task.policy) - compactTaskGraph.energy(id, task.policy + 1);
+    };
+
+    if (mode == SpeedupMode::Cheapest) ranking.rank(taskGraph, compactTaskGraph);
+    const bool timed = deadline != std::chrono::steady_clock::time_point::max();
+    while (criticalTime > desiredTime) {
+        if (timed && std::chrono::steady_clock::now() >= deadline) return false;
+        if (mode == SpeedupMode::MinCut) {
+            findCriticalCut(taskGraph, compactTaskGraph, criticalTime, maxFlow, nodeOf, cut);
+            if (cut.empty()) return false;
+            for (int id : cut) speedup(id);
+        } else if (mode == SpeedupMode::Cheapest) {
+            const auto taskToSpeedupOpt = ranking.cheapestCritical(criticalTime);
+            if (!taskToSpeedupOpt) return false;
+            speedup(*taskToSpeedupOpt);
+            ranking.taskChanged(*taskToSpeedupOpt);
+        } else {
+            const auto taskToSpeedupOpt = findTaskToSpeedup(criticalPath, taskGraph);
+            if (!taskToSpeedupOpt) return false;
+            speedup(*taskToSpeedupOpt);
+        }
+        if (onPath) criticalPathTracker.criticalPath(criticalPath);
+        criticalTime = criticalPathTracker.criticalTime();
+        if (trace) trace->sample("speedup", ++step, criticalTime, energy);
+    }
+    return true;
+}
@@ -0,0 +1,235 @@
+#pragma once
+
+#include <vector>
+#include <optional>
+#include <functional>
+#include <algorithm>
+#include <chrono>
+#include <string_view>
+#include "taskGraph.h"
+#include "maxFlow.h"
+#include "trace.h"
+
+
+// One pass over the topological order for Early and one back for Late (stored negative).
+// The weights and links are read from the CompactTaskGraph, so the Tasks may be blank.
+void recalculateEarlyLate(TaskGraph& taskGraph, const CompactTaskGraph& compactTaskGraph,
+        const std::vector<int>& topologicalOrder);
+
+// Follows the Targets whose Late continues the critical path.
+// Throws std::logic_error if none does, as then Late is out of date.
+std::vector<int> getCriticalPathFrom(int rootId, const TaskGraph& taskGraph, const CompactTaskGraph& compactTaskGraph);
+// Into the vector, keeping its storage
+void getCriticalPathFrom(int rootId, const TaskGraph& taskGraph, const CompactTaskGraph& compactTaskGraph,
+        std::vector<int>& criticalPath);
+
+// The critical path and time, empty and 0 without root Tasks
+std::pair<std::vector<int>, int> recalculateStats(TaskGraph& taskGraph, const CompactTaskGraph& compactTaskGraph,
+        const std::vector<int>& rootTaskIndices, const std::vector<int>& topologicalOrder);
+
+std::optional<int> findTaskToSpeedup(const std::vector<int>& path, const TaskGraph& taskGraph);
+
+// Moves the entry of the sorted vector to its place after its key has changed
+template<typename Entry>
+void moveToPlace(std::vector<Entry>& sorted, typename std::vector<Entry>::iterator entry) {
+    for (; entry != sorted.begin() && *entry < *(entry - 1); entry--) std::iter_swap(entry, entry - 1);
+    for (; entry + 1 != sorted.end() && *(entry + 1) < *entry; entry++) std::iter_swap(entry, entry + 1);
+}
+
+
+// Keeps Early/Late up to date as the policies change one Task at a time,
+// visiting only the Tasks whose values change
+struct CriticalPathTracker {
+    TaskGraph& taskGraph;
+    const CompactTaskGraph& compactTaskGraph;
+    const std::vector<int>& topologicalOrder;
+    std::vector<int> positionOf; // in topologicalOrder
+    std::vector<bool> queued;
+    std::vector<int> heap; // of positions, reused between updates
+    std::vector<std::pair<int, int>> rootsByLate; // <late, id> sorted, so the first one is the critical root
+    Trace* trace = nullptr; // that counts the recalculations, if any
+
+    CriticalPathTracker(TaskGraph& taskGraph, const CompactTaskGraph& compactTaskGraph,
+            const std::vector<int>& rootTaskIndices, const std::vector<int>& topologicalOrder)
+            : taskGraph(taskGraph), compactTaskGraph(compactTaskGraph), topologicalOrder(topologicalOrder),
+              positionOf(taskGraph.tasks.size()), queued(taskGraph.tasks.size(), false) {
+        for (unsigned int position = 0; position < topologicalOrder.size(); position++) {
+            positionOf[topologicalOrder[position]] = position;
+        }
+        recalculateEarlyLate(taskGraph, compactTaskGraph, topologicalOrder);
+        for (int id : rootTaskIndices) rootsByLate.emplace_back(*taskGraph.tasks[id].late, id);
+        std::sort(rootsByLate.begin(), rootsByLate.end());
+    }
+
+    // From scratch, after the policies of many Tasks have changed at once
+    void recalculate() {
+        recalculateEarlyLate(taskGraph, compactTaskGraph, topologicalOrder);
+        if (trace) trace->count(Trace::Counter::Recalculations, 2 * topologicalOrder.size());
+        for (auto& [late, id] : rootsByLate) late = *taskGraph.tasks[id].late;
+        std::sort(rootsByLate.begin(), rootsByLate.end());
+    }
+
+    int criticalTime() const noexcept { return -rootsByLate.begin()->first; }
+    std::vector<int> criticalPath() const {
+        return getCriticalPathFrom(rootsByLate.begin()->second, taskGraph, compactTaskGraph);
+    }
+    void criticalPath(std::vector<int>& path) const {
+        getCriticalPathFrom(rootsByLate.begin()->second, taskGraph, compactTaskGraph, path);
+    }
+
+    // To be called after the weight (policy) of the Task has changed
+    void taskChanged(int id) {
+        int recalculations = 0;
+        // Early of the Task itself depends only on its parents, so start from the Targets
+        for (const auto& [dst, _volume] : compactTaskGraph.successorsOf(id)) enqueue(dst, std::greater<int>());
+        while (!heap.empty()) {
+            const int currId = topologicalOrder[dequeue(std::greater<int>())];
+            recalculations++;
+            auto& task = taskGraph.tasks[currId];
+            int early = 0;
+            for (const auto& [parent, _volume] : compactTaskGraph.predecessorsOf(currId)) {
+                const auto& parentTask = taskGraph.tasks[parent];
+                const int parentFinish = *parentTask.early + weightOf(parent);
+                if (parentFinish > early) early = parentFinish;
+            }
+            if (early == *task.early) continue;
+            task.early = { early };
+            for (const auto& [dst, _volume] : compactTaskGraph.successorsOf(currId)) enqueue(dst, std::greater<int>());
+        }
+
+        // Late of the Task itself changes with its weight, so start from it
+        enqueue(id, std::less<int>());
+        while (!heap.empty()) {
+            const int currId = topologicalOrder[dequeue(std::less<int>())];
+            recalculations++;
+            auto& task = taskGraph.tasks[currId];
+            int min = 0;
+            for (const auto& [dst, _volume] : compactTaskGraph.successorsOf(currId)) {
+                const int targetLate = *taskGraph.tasks[dst].late;
+                if (targetLate < min) min = targetLate;
+            }
+            const int late = min - weightOf(currId);
+            if (late == *task.late) continue;
+            const auto parents = compactTaskGraph.predecessorsOf(currId);
+            if (parents.empty()) {
+                const auto root = std::lower_bound(rootsByLate.begin(), rootsByLate.end(),
+                        std::make_pair(*task.late, currId));
+                root->first = late;
+                moveToPlace(rootsByLate, root);
+            }
+            task.late = { late };
+            for (const auto& [parent, _volume] : parents) enqueue(parent, std::less<int>());
+        }
+        if (trace) trace->count(Trace::Counter::Recalculations, recalculations);
+    }
+
+private:
+    int weightOf(int id) const noexcept { return compactTaskGraph.weight(id, taskGraph.tasks[id].policy); }
+
+    // Compare == std::greater gives the earliest position first, std::less the latest
+    template<typename Compare>
+    void enqueue(int id, Compare compare) {
+        if (queued[id]) return;
+        queued[id] = true;
+        heap.push_back(positionOf[id]);
+        std::push_heap(heap.begin(), heap.end(), compare);
+    }
+
+    template<typename Compare>
+    int dequeue(Compare compare) {
+        std::pop_heap(heap.begin(), heap.end(), compare);
+        const int position = heap.back();
+        heap.pop_back();
+        queued[topologicalOrder[position]] = false;
+        return position;
+    }
+};
+
+// The cheapest improvable Tasks that cut every critical path, by the energy their
+// next faster policies add. Empty if some critical path cannot improve.
+void findCriticalCut(const TaskGraph& taskGraph, const CompactTaskGraph& compactTaskGraph,
+        int criticalTime, MaxFlow& maxFlow, std::vector<int>& nodeOf, std::vector<int>& cut);
+
+// The energy the next faster policy adds per unit of weight it saves.
+// Infinite if it saves nothing.
+double speedupCost(const CompactTaskGraph& compactTaskGraph, int id, int policy) noexcept;
+
+// The improvable Tasks sorted by speedupCost(), kept sorted one policy change at a time
+struct SpeedupRanking {
+    const TaskGraph* taskGraph = nullptr;
+    const CompactTaskGraph* compactTaskGraph = nullptr;
+    std::vector<double> costOf;
+    std::vector<std::pair<double, int>> byCost; // <cost, id> sorted, the improvable Tasks only
+
+    // Of the Tasks of the graph from their policies
+    void rank(const TaskGraph& taskGraph, const CompactTaskGraph& compactTaskGraph) {
+        this->taskGraph = &taskGraph;
+        this->compactTaskGraph = &compactTaskGraph;
+        costOf.resize(taskGraph.tasks.size());
+        byCost.clear();
+        byCost.reserve(taskGraph.tasks.size()); // so that taskChanged() never grows it
+        for (unsigned int id = 0; id < taskGraph.tasks.size(); id++) {
+            const auto& task = taskGraph.tasks[id];
+            if (!task.canImprove()) continue;
+            costOf[id] = speedupCost(compactTaskGraph, id, task.policy);
+            byCost.emplace_back(costOf[id], id);
+        }
+        std::sort(byCost.begin(), byCost.end());
+    }
+
+    // To be called after the policy of the Task has changed
+    void taskChanged(int id) {
+        const auto& task = taskGraph->tasks[id];
+        const auto entry = std::lower_bound(byCost.begin(), byCost.end(), std::make_pair(costOf[id], id));
+        const bool ranked = entry != byCost.end() && entry->second == id;
+        if (!task.canImprove()) {
+            if (ranked) byCost.erase(entry);
+            return;
+        }
+        costOf[id] = speedupCost(*compactTaskGraph, id, task.policy);
+        if (ranked) {
+            entry->first = costOf[id];
+            moveToPlace(byCost, entry);
+        } else {
+            const std::pair<double, int> ranking{ costOf[id], id };
+            byCost.insert(std::lower_bound(byCost.begin(), byCost.end(), ranking), ranking);
+        }
+    }
+
+    // The cheapest improvable Task without slack, i.e. on some critical path.
+    // The Tasks cheaper than it are walked. None if no critical Task can improve.
+    std::optional<int> cheapestCritical(int criticalTime) const {
+        for (const auto& [_cost, id] : byCost) {
+            const auto& task = taskGraph->tasks[id];
+            if (*task.early - *task.late == criticalTime) return { id };
+        }
+        return std::nullopt;
+    }
+};
+
+enum class SpeedupMode {
+    FirstOnPath, // one Task of one critical path per step
+    MinCut, // a findCriticalCut() per step, so every critical path gets shorter at once
+    Cheapest // the SpeedupRanking::cheapestCritical() Task per step
+};
+
+// "path", "cut" or "cheapest"
+std::optional<SpeedupMode> parseSpeedupMode(std::string_view name) noexcept;
+
+// The buffers of speedupCriticalPath()
+struct SpeedupWorkspace {
+    std::vector<int> criticalPath;
+    MaxFlow maxFlow;
+    std::vector<int> nodeOf;
+    std::vector<int> cut;
+    SpeedupRanking ranking; // with SpeedupMode::Cheapest
+};
+
+// Speeds up the Tasks the mode picks until the critical time meets the desired
+// one. False if it cannot, or once the deadline has passed.
+// Every step is counted and sampled in the trace of the tracker, if any.
+bool speedupCriticalPath(TaskGraph& taskGraph, CriticalPathTracker& criticalPathTracker,
+        int desiredTime, SpeedupMode mode = SpeedupMode::FirstOnPath);
+bool speedupCriticalPath(TaskGraph& taskGraph, CriticalPathTracker& criticalPathTracker,
+        int desiredTime, SpeedupMode mode, SpeedupWorkspace& workspace,
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max());
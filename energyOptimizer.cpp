@@ -0,0 +1,180 @@
+#include "energyOptimizer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+
+struct LagrangianPath {
+    std::vector<int> tasks;
+    double multiplier = 0.0;
+    int excess = 0; // length - desired time, under the relaxed policies
+};
+
+int totalEnergyOf(const TaskGraph& taskGraph, const CompactTaskGraph& compactTaskGraph) {
+    int totalEnergy = 0;
+    for (int id = 0; id < compactTaskGraph.tasksCount; id++) {
+        totalEnergy += compactTaskGraph.energy(id, taskGraph.tasks[id].policy);
+    }
+    return totalEnergy;
+}
+
+// Speeds up minimum cuts until the desired time is met, then slows down every
+// Task whose slack allows it, the largest savings first, until none can be.
+// False if even the fastest policies are too slow, or the deadline passes
+// before they are found. Once it passes the slowing down stops, the policies
+// meeting the desired time all along.
+bool makeFeasible(TaskGraph& taskGraph, CriticalPathTracker& criticalPathTracker, int desiredTime,
+        std::vector<int>& order, SpeedupWorkspace& workspace, std::chrono::steady_clock::time_point deadline) {
+    if (!speedupCriticalPath(taskGraph, criticalPathTracker, desiredTime, SpeedupMode::MinCut, workspace, deadline)) {
+        return false;
+    }
+    const auto& compactTaskGraph = criticalPathTracker.compactTaskGraph;
+    const auto savingOf = [&taskGraph, &compactTaskGraph](int id){
+        const int policy = taskGraph.tasks[id].policy;
+        return compactTaskGraph.energy(id, policy) - compactTaskGraph.energy(id, policy + 1);
+    };
+    bool slowedDown = true;
+    while (slowedDown && std::chrono::steady_clock::now() < deadline) {
+        slowedDown = false;
+        order.clear();
+        for (int id = 0; id < compactTaskGraph.tasksCount; id++) {
+            if (taskGraph.tasks[id].policy + 1 < compactTaskGraph.policiesCount && savingOf(id) > 0) order.push_back(id);
+        }
+        std::stable_sort(order.begin(), order.end(), [&savingOf](int a, int b){ return savingOf(a) > savingOf(b); });
+        for (int id : order) {
+            auto& task = taskGraph.tasks[id];
+            const int added = compactTaskGraph.weight(id, task.policy + 1) - compactTaskGraph.weight(id, task.policy);
+            // The longest path through the Task gets longer by as much
+            if (*task.early - *task.late + added > desiredTime) continue;
+            task.policy++;
+            criticalPathTracker.taskChanged(id);
+            slowedDown = true;
+        }
+    }
+    return true;
+}
+
+EnergyOptimization minimizeEnergy(TaskGraph& taskGraph, CriticalPathTracker& criticalPathTracker,
+        int desiredTime, const EnergyBudget& budget) {
+    const auto start = std::chrono::steady_clock::now();
+    const auto elapsedMs = [&start](){
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+    // Within makeFeasible() too, as a step of it may take long on a large graph
+    const auto deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double, std::milli>(std::min(budget.milliseconds, 1e12)));
+    const auto& compactTaskGraph = criticalPathTracker.compactTaskGraph;
+    const int tasksCount = compactTaskGraph.tasksCount;
+    const int policiesCount = compactTaskGraph.policiesCount;
+    EnergyOptimization optimization;
+
+    std::vector<int> bestPolicies(tasksCount);
+    for (int id = 0; id < tasksCount; id++) bestPolicies[id] = taskGraph.tasks[id].policy;
+    if (tasksCount == 0 || criticalPathTracker.criticalTime() <= desiredTime) {
+        optimization.feasible = true;
+        optimization.energy = totalEnergyOf(taskGraph, compactTaskGraph);
+    }
+
+    std::vector<LagrangianPath> paths;
+    std::vector<double> charge(tasksCount); // the sum of the multipliers of the paths through the Task
+    std::vector<int> order;
+    std::vector<int> criticalPath;
+    SpeedupWorkspace speedupWorkspace;
+    double stepScale = 2.0;
+    int sinceImproved = 0;
+    while (tasksCount > 0 && optimization.iterations < budget.iterations && elapsedMs() < budget.milliseconds) {
+        optimization.iterations++;
+
+        // The relaxation: the cheapest policy of every Task on its own
+        std::fill(charge.begin(), charge.end(), 0.0);
+        double value = 0.0;
+        for (const auto& path : paths) {
+            for (int id : path.tasks) charge[id] += path.multiplier;
+            value -= path.multiplier * desiredTime;
+        }
+        for (int id = 0; id < tasksCount; id++) {
+            int bestPolicy = policiesCount - 1;
+            double bestCost = std::numeric_limits<double>::max();
+            for (int policy = policiesCount - 1; policy >= 0; policy--) { // the slower wins a tie
+                const double cost = compactTaskGraph.energy(id, policy) + charge[id] * compactTaskGraph.weight(id, policy);
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestPolicy = policy;
+                }
+            }
+            taskGraph.tasks[id].policy = bestPolicy;
+            value += bestCost;
+        }
+        if (value > optimization.lowerBound + 1e-9 || optimization.iterations == 1) {
+            optimization.lowerBound = std::max(optimization.lowerBound, value);
+            sinceImproved = 0;
+        } else if (++sinceImproved == 20) {
+            stepScale /= 2.0;
+            sinceImproved = 0;
+        }
+
+        // The subgradient: how much every path misses the desired time by
+        criticalPathTracker.recalculate();
+        for (auto& path : paths) {
+            int length = 0;
+            for (int id : path.tasks) length += compactTaskGraph.weight(id, taskGraph.tasks[id].policy);
+            path.excess = length - desiredTime;
+        }
+        if (criticalPathTracker.criticalTime() > desiredTime) {
+            criticalPathTracker.criticalPath(criticalPath);
+            const bool known = std::any_of(paths.begin(), paths.end(),
+                    [&criticalPath](const auto& path){ return path.tasks == criticalPath; });
+            if (!known) paths.push_back({ criticalPath, 0.0, criticalPathTracker.criticalTime() - desiredTime });
+        }
+
+        // The upper bound
+        if (!makeFeasible(taskGraph, criticalPathTracker, desiredTime, order, speedupWorkspace, deadline)) break;
+        const int energy = totalEnergyOf(taskGraph, compactTaskGraph);
+        if (Trace* const trace = criticalPathTracker.trace) {
+            trace->sample("minimize_energy", optimization.iterations, criticalPathTracker.criticalTime(), energy);
+        }
+        if (!optimization.feasible || energy < optimization.energy) {
+            optimization.feasible = true;
+            optimization.energy = energy;
+            for (int id = 0; id < tasksCount; id++) bestPolicies[id] = taskGraph.tasks[id].policy;
+        }
+        // The energies are whole, so a bound within 1 proves optimality
+        if (optimization.energy - optimization.lowerBound < 1.0 - 1e-9) break;
+
+        // Polyak's step towards the best energy, the multipliers staying non-negative
+        double normSquared = 0.0;
+        for (const auto& path : paths) {
+            if (path.multiplier > 0.0 || path.excess > 0) normSquared += static_cast<double>(path.excess) * path.excess;
+        }
+        if (normSquared == 0.0) break;
+        const double step = stepScale * (optimization.energy - value) / normSquared;
+        for (auto& path : paths) path.multiplier = std::max(0.0, path.multiplier + step * path.excess);
+        paths.erase(std::remove_if(paths.begin(), paths.end(),
+                    [](const auto& path){ return path.multiplier == 0.0 && path.excess <= 0; }), paths.end());
+    }
+
+    for (int id = 0; id < tasksCount; id++) taskGraph.tasks[id].policy = bestPolicies[id];
+    if (tasksCount > 0) criticalPathTracker.recalculate();
+    optimization.elapsedMs = elapsedMs();
+    return optimization;
+}
+
+void printEnergyComparison(const TaskGraph& taskGraph, const CompactTaskGraph& compactTaskGraph,
+        const std::vector<int>& otherPolicies, const EnergyOptimization& optimization, std::ostream& os) {
+    if (!optimization.feasible) {
+        os << "No policies meet the desired time.\n";
+        return;
+    }
+    int otherEnergy = 0;
+    for (unsigned int id = 0; id < taskGraph.tasks.size(); id++) {
+        const auto& task = taskGraph.tasks[id];
+        os << "Task {" << id << "} is on V(" << task.policy << ")";
+        if (otherPolicies[id] != task.policy) os << " instead of V(" << otherPolicies[id] << ")";
+        os << '\n';
+        otherEnergy += compactTaskGraph.energy(id, otherPolicies[id]);
+    }
+    os << "Total energy consumption = " << optimization.energy << " instead of " << otherEnergy << '\n';
+    os << "Lower bound = " << optimization.lowerBound << ", gap = " << optimization.gap() * 100.0 << "% after "
+        << optimization.iterations << " iterations in " << optimization.elapsedMs << " ms\n";
+}
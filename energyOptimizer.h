@@ -0,0 +1,38 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include "taskGraph.h"
+#include "criticalPath.h"
+
+
+struct EnergyBudget {
+    double milliseconds = 100.0;
+    int iterations = 1000;
+};
+
+struct EnergyOptimization {
+    bool feasible = false; // whether any policies meet the desired time
+    int energy = 0; // of the best policies found
+    double lowerBound = 0.0; // on the energy of any policies that meet the desired time
+    int iterations = 0;
+    double elapsedMs = 0.0;
+
+    // Relative to the energy found, 0 once it is proven optimal
+    double gap() const noexcept {
+        if (!feasible || energy <= 0) return 0.0;
+        return std::max(0.0, (energy - lowerBound) / energy);
+    }
+};
+
+// The least energy that meets the desired time, by Lagrangian relaxation of the
+// critical paths, until the bounds meet or the budget runs out. Never worse than
+// the policies in the Tasks if they meet it, and leaves the best ones found there.
+EnergyOptimization minimizeEnergy(TaskGraph& taskGraph, CriticalPathTracker& criticalPathTracker,
+        int desiredTime, const EnergyBudget& budget);
+
+// In the terms of printResult(): the policy of every Task, next to the
+// policy the other solver chose where they differ, then both totals and the bound
+void printEnergyComparison(const TaskGraph& taskGraph, const CompactTaskGraph& compactTaskGraph,
+        const std::vector<int>& otherPolicies, const EnergyOptimization& optimization, std::ostream& os = std::cout);
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <vector>
+#include <limits>
+#include <utility>
+#include <algorithm>
+
+
+// The gaps between the events of a timeline, the last one unbounded, in an
+// implicit treap that knows its longest slot per subtree
+struct FreeSlots {
+    static constexpr int UNBOUNDED = std::numeric_limits<int>::max();
+
+    struct Node {
+        int start, end;
+        int maxLength, size; // of the subtree
+        unsigned int priority;
+        int left = -1, right = -1;
+        Node(int start, int end, unsigned int priority) noexcept
+            : start(start), end(end), maxLength(end - start), size(1), priority(priority) {}
+        int length() const noexcept { return end - start; }
+    };
+    std::vector<Node> nodes;
+    int root;
+
+    FreeSlots() noexcept : root(newNode(0, UNBOUNDED)) {}
+
+    // Back to a single unbounded slot, keeping the storage
+    void clear() {
+        nodes.clear();
+        root = newNode(0, UNBOUNDED);
+    }
+
+    // Where the last event finishes
+    int lastStart() const noexcept {
+        int node = root;
+        while (nodes[node].right != -1) node = nodes[node].right;
+        return nodes[node].start;
+    }
+
+    // The earliest time at or after let at which [time, time + duration) is free
+    int earliestFit(int duration, int let) const noexcept {
+        return earliestWindow(duration, let).first;
+    }
+
+    // The same time, with the end of the free slot it is in: <time, end>
+    std::pair<int, int> earliestWindow(int duration, int let) const noexcept {
+        // Slot ends grow with the position, so the first slot that is not over by
+        // let is the only one that may start before let
+        const auto [position, node] = firstEndingAtOrAfter(let);
+        const int start = std::max(let, nodes[node].start);
+        if (nodes[node].end - start >= duration) return std::make_pair(start, nodes[node].end);
+        const auto& slot = nodes[firstFitAfter(root, 0, position + 1, duration)];
+        return std::make_pair(slot.start, slot.end);
+    }
+
+    // [start, finish) must be free, e.g. as returned by earliestFit()
+    void occupy(int start, int finish) {
+        const int position = firstEndingAtOrAfter(finish).first;
+        const int after = newNode(finish, 0);
+        int left, middle, right;
+        split(root, position, left, right);
+        split(right, 1, middle, right);
+        nodes[after].end = nodes[middle].end;
+        nodes[middle].end = start;
+        update(after);
+        update(middle);
+        root = merge(merge(left, middle), merge(after, right));
+    }
+
+private:
+    int sizeOf(int node) const noexcept { return node == -1 ? 0 : nodes[node].size; }
+    int maxLengthOf(int node) const noexcept { return node == -1 ? -1 : nodes[node].maxLength; }
+
+    int newNode(int start, int end) {
+        // Any well mixed sequence will do; a fixed one keeps the shape reproducible
+        unsigned int priority = nodes.size() * 2654435761u;
+        priority ^= priority >> 16;
+        nodes.emplace_back(start, end, priority);
+        return nodes.size() - 1;
+    }
+
+    void update(int node) noexcept {
+        auto& n = nodes[node];
+        n.size = 1 + sizeOf(n.left) + sizeOf(n.right);
+        n.maxLength = std::max({ n.length(), maxLengthOf(n.left), maxLengthOf(n.right) });
+    }
+
+    // <position, node>
+    std::pair<int, int> firstEndingAtOrAfter(int time) const noexcept {
+        int node = root, offset = 0;
+        std::pair<int, int> found(-1, -1);
+        while (node != -1) {
+            const auto& n = nodes[node];
+            if (n.end >= time) {
+                found = std::make_pair(offset + sizeOf(n.left), node);
+                node = n.left;
+            } else {
+                offset += sizeOf(n.left) + 1;
+                node = n.right;
+            }
+        }
+        return found;
+    }
+
+    // The first node at a position >= minPosition that fits the duration
+    int firstFitAfter(int node, int offset, int minPosition, int duration) const noexcept {
+        if (node == -1 || nodes[node].maxLength < duration) return -1;
+        if (offset + nodes[node].size <= minPosition) return -1;
+        const auto& n = nodes[node];
+        const int found = firstFitAfter(n.left, offset, minPosition, duration);
+        if (found != -1) return found;
+        const int position = offset + sizeOf(n.left);
+        if (position >= minPosition && n.length() >= duration) return node;
+        return firstFitAfter(n.right, position + 1, minPosition, duration);
+    }
+
+    // The first count slots go to left
+    void split(int node, int count, int& left, int& right) noexcept {
+        if (node == -1) {
+            left = right = -1;
+            return;
+        }
+        if (sizeOf(nodes[node].left) < count) {
+            split(nodes[node].right, count - sizeOf(nodes[node].left) - 1, nodes[node].right, right);
+            left = node;
+        } else {
+            split(nodes[node].left, count, left, nodes[node].left);
+            right = node;
+        }
+        update(node);
+    }
+
+    int merge(int left, int right) noexcept {
+        if (left == -1) return right;
+        if (right == -1) return left;
+        if (nodes[left].priority > nodes[right].priority) {
+            nodes[left].right = merge(nodes[left].right, right);
+            update(left);
+            return left;
+        }
+        nodes[right].left = merge(left, nodes[right].left);
+        update(right);
+        return right;
+    }
+};
@@ -0,0 +1,316 @@
+#include "generators.h"
+
+#include <unordered_set>
+#include <charconv>
+#include "criticalPath.h"
+
+
+void addRandomTask(TaskGraph& taskGraph, const TaskModel& model, std::mt19937& engine) {
+    const int MAX_ENERGY_SLOWEST = 40;
+    const float SPEEDUP_ENERGY_MAGNIFIER = 1.7f;
+    const float SPEEDUP_WEIGHT_MAGNIFIER = 0.7f;
+    const int policies = model.policies;
+    const auto energyOf = [policies, highTime = model.highTime,
+          MAX_ENERGY_SLOWEST, SPEEDUP_ENERGY_MAGNIFIER](int time, int policy){
+        float energy = static_cast<float>(time) / static_cast<float>(highTime) * MAX_ENERGY_SLOWEST;
+        for (int i = 0; i < policies - policy - 1; i++) energy *= SPEEDUP_ENERGY_MAGNIFIER;
+        return static_cast<int>(energy);
+    };
+
+    std::vector<int> weights(policies, 0);
+    std::vector<int> energies(policies, 0);
+    const float timeF = getRandomUniformInt(engine, model.lowTime, model.highTime);
+    for (int policy = 0; policy < policies; policy++) {
+        float time = timeF;
+        for (int j = 0; j < policies - policy - 1; j++) time *= SPEEDUP_WEIGHT_MAGNIFIER;
+        if (time <= 1.0f) time = 1.01f;
+        const int energy = energyOf(timeF, policy);
+        weights[policy] = time;
+        energies[policy] = energy;
+    }
+    taskGraph.add(std::move(weights), std::move(energies));
+}
+
+void addRandomTransfer(TaskGraph& taskGraph, int src, int dst, const TaskModel& model, std::mt19937& engine) {
+    taskGraph.addTransfer(src, dst, getRandomUniformInt(engine, model.lowVolume, model.highVolume));
+}
+
+int getDesiredTime(TaskGraph& taskGraph, const CompactTaskGraph& compactTaskGraph) {
+    if (taskGraph.tasks.empty()) return 0;
+    const int policies = compactTaskGraph.policiesCount;
+    std::vector<int> rootTaskIndices;
+    getRootTasks(compactTaskGraph, rootTaskIndices);
+    for (auto& task : taskGraph.tasks) task.policy = policies - 1; // slowest
+    const auto topologicalOrder = getTopologicalOrder(compactTaskGraph);
+    const auto [_criticalPathSlowest, criticalTimeSlowest] = recalculateStats(taskGraph, compactTaskGraph,
+            rootTaskIndices, topologicalOrder);
+    for (auto& task : taskGraph.tasks) task.policy = 0; // fastest
+    const auto [_criticalPathFastest, criticalTimeFastest] = recalculateStats(taskGraph, compactTaskGraph,
+            rootTaskIndices, topologicalOrder);
+    return (criticalTimeFastest + criticalTimeSlowest) / 2;
+}
+
+int getDesiredTime(TaskGraph& taskGraph) {
+    return getDesiredTime(taskGraph, CompactTaskGraph(taskGraph));
+}
+
+int getDesiredTime(const CompactTaskGraph& compactTaskGraph) {
+    TaskGraph taskGraph(compactTaskGraph.indexingFromZero);
+    makeBlankTaskGraph(compactTaskGraph, taskGraph);
+    return getDesiredTime(taskGraph, compactTaskGraph);
+}
+
+std::pair<TaskGraph, int> generateRandomTaskGraph(int N, int policies, float connectivity,
+        int lowTime, int highTime, int lowVolume, int highVolume, std::mt19937& engine) noexcept {
+    const TaskModel model{ policies, lowTime, highTime, lowVolume, highVolume };
+    TaskGraph taskGraph(true);
+    taskGraph.tasks.reserve(N);
+    for (int n = 0; n < N; n++) addRandomTask(taskGraph, model, engine);
+
+    const int LINKS_COUNT = static_cast<int>(connectivity * N * (N - 1) / 2);
+    const long long PAIRS_COUNT = static_cast<long long>(N) * (N - 1) / 2;
+    // The pairs drawn so far, by the index of (a < b) among all pairs. A bitmap
+    // unless the graph is so sparse that a hash set takes less memory.
+    struct DrawnPairs {
+        bool dense;
+        std::vector<bool> bitmap;
+        std::unordered_set<long long> set;
+        DrawnPairs(long long pairsCount, long long expected) : dense(pairsCount <= 256 * expected) {
+            if (dense) bitmap.resize(pairsCount, false);
+            else set.reserve(expected);
+        }
+        bool insert(long long index) {
+            if (!dense) return set.insert(index).second;
+            if (bitmap[index]) return false;
+            bitmap[index] = true;
+            return true;
+        }
+        bool contains(long long index) const { return dense ? bitmap[index] : set.count(index) > 0; }
+    };
+    const auto pairIndex = [N](int a, int b){
+        return static_cast<long long>(a) * (2 * N - a - 1) / 2 + (b - a - 1);
+    };
+    // A pair (a < b) is drawn with the same sequence of getRandomUniformInt() calls
+    // as always, and rejected in O(1) if already drawn. If nearly all pairs are to
+    // be linked, the pairs to leave out are drawn instead, so that the rejections
+    // stay rare at any connectivity.
+    const auto drawNewPair = [N, &pairIndex, &engine](DrawnPairs& drawn){
+        while (true) {
+            const int a = getRandomUniformInt(engine, 0, N - 2);
+            const int b = getRandomUniformInt(engine, a + 1, N - 1);
+            if (drawn.insert(pairIndex(a, b))) return std::make_pair(a, b);
+        }
+    };
+
+    std::vector<Transfer> links;
+    links.reserve(LINKS_COUNT);
+    if (LINKS_COUNT <= PAIRS_COUNT * 9 / 10) {
+        DrawnPairs linked(PAIRS_COUNT, LINKS_COUNT);
+        for (int link = 0; link < LINKS_COUNT; link++) {
+            const auto [a, b] = drawNewPair(linked);
+            const int volume = getRandomUniformInt(engine, lowVolume, highVolume);
+            links.emplace_back(a, b, volume);
+        }
+    } else {
+        DrawnPairs omitted(PAIRS_COUNT, PAIRS_COUNT - LINKS_COUNT);
+        for (long long omit = 0; omit < PAIRS_COUNT - LINKS_COUNT; omit++) drawNewPair(omitted);
+        for (int a = 0; a < N - 1; a++) {
+            for (int b = a + 1; b < N; b++) {
+                if (omitted.contains(pairIndex(a, b))) continue;
+                const int volume = getRandomUniformInt(engine, lowVolume, highVolume);
+                links.emplace_back(a, b, volume);
+            }
+        }
+    }
+
+    // Every list gets its final size right away
+    std::vector<int> targetsCount(N, 0);
+    std::vector<int> parentsCount(N, 0);
+    for (const auto& [a, b, _volume] : links) {
+        targetsCount[a]++;
+        parentsCount[b]++;
+    }
+    for (int n = 0; n < N; n++) {
+        taskGraph.tasks[n].targets.reserve(targetsCount[n]);
+        taskGraph.tasks[n].parents.reserve(parentsCount[n]);
+    }
+    taskGraph.transfers.reserve(links.size());
+    for (const auto& [a, b, volume] : links) {
+        taskGraph.addTransfer(a, b, volume);
+        // if (findCycle(taskGraph, getTopologicalOrder(taskGraph))) {
+        //     taskGraph.removeLastTransfer(a, b);
+        //     continue;
+        // }
+    }
+
+    const int desiredTime = getDesiredTime(taskGraph);
+    return std::make_pair(taskGraph, desiredTime);
+}
+
+// ========== Structured workloads ========== //
+// Each instance is determined by its parameters and the seed alone.
+
+std::pair<TaskGraph, int> generateLayeredTaskGraph(int width, int depth, float connectivity,
+        const TaskModel& model, unsigned int seed) {
+    std::mt19937 engine(seed);
+    std::bernoulli_distribution linked(connectivity);
+    TaskGraph taskGraph(true);
+    taskGraph.tasks.reserve(width * depth);
+    for (int n = 0; n < width * depth; n++) addRandomTask(taskGraph, model, engine);
+    for (int layer = 1; layer < depth; layer++) {
+        const int previousLayer = (layer - 1) * width;
+        for (int dst = layer * width; dst < (layer + 1) * width; dst++) {
+            const int mainParent = previousLayer + getRandomUniformInt(engine, 0, width - 1);
+            addRandomTransfer(taskGraph, mainParent, dst, model, engine);
+            for (int src = previousLayer; src < previousLayer + width; src++) {
+                if (src != mainParent && linked(engine)) addRandomTransfer(taskGraph, src, dst, model, engine);
+            }
+        }
+    }
+
+    const int desiredTime = getDesiredTime(taskGraph);
+    return std::make_pair(std::move(taskGraph), desiredTime);
+}
+
+std::pair<TaskGraph, int> generateForkJoinTaskGraph(int branches, int stages,
+        const TaskModel& model, unsigned int seed) {
+    std::mt19937 engine(seed);
+    TaskGraph taskGraph(true);
+    taskGraph.tasks.reserve(1 + stages * (branches + 1));
+    addRandomTask(taskGraph, model, engine);
+    int fork = 0;
+    for (int stage = 0; stage < stages; stage++) {
+        const int firstBranch = taskGraph.tasks.size();
+        for (int branch = 0; branch <= branches; branch++) addRandomTask(taskGraph, model, engine);
+        const int join = firstBranch + branches;
+        for (int branch = firstBranch; branch < join; branch++) {
+            addRandomTransfer(taskGraph, fork, branch, model, engine);
+            addRandomTransfer(taskGraph, branch, join, model, engine);
+        }
+        fork = join;
+    }
+
+    const int desiredTime = getDesiredTime(taskGraph);
+    return std::make_pair(std::move(taskGraph), desiredTime);
+}
+
+std::pair<int, int> addSeriesParallel(int size, TaskGraph& taskGraph, const TaskModel& model, std::mt19937& engine) {
+    if (size == 1) {
+        addRandomTask(taskGraph, model, engine);
+        return std::make_pair(taskGraph.tasks.size() - 1, taskGraph.tasks.size() - 1);
+    }
+    const auto splitOf = [&engine](int size){
+        return std::max(1, getRandomUniformInt(engine, size / 4, size - size / 4 - 1));
+    };
+    if (size < 4 || getRandomUniformInt(engine, 0, 1) == 0) { // series
+        const int first = splitOf(size);
+        const auto [entry, firstExit] = addSeriesParallel(first, taskGraph, model, engine);
+        const auto [secondEntry, exit] = addSeriesParallel(size - first, taskGraph, model, engine);
+        addRandomTransfer(taskGraph, firstExit, secondEntry, model, engine);
+        return std::make_pair(entry, exit);
+    }
+    // parallel, between a fork and a join
+    addRandomTask(taskGraph, model, engine);
+    const int fork = taskGraph.tasks.size() - 1;
+    const int first = splitOf(size - 2);
+    const auto [firstEntry, firstExit] = addSeriesParallel(first, taskGraph, model, engine);
+    const auto [secondEntry, secondExit] = addSeriesParallel(size - 2 - first, taskGraph, model, engine);
+    addRandomTask(taskGraph, model, engine);
+    const int join = taskGraph.tasks.size() - 1;
+    addRandomTransfer(taskGraph, fork, firstEntry, model, engine);
+    addRandomTransfer(taskGraph, fork, secondEntry, model, engine);
+    addRandomTransfer(taskGraph, firstExit, join, model, engine);
+    addRandomTransfer(taskGraph, secondExit, join, model, engine);
+    return std::make_pair(fork, join);
+}
+
+std::pair<TaskGraph, int> generateSeriesParallelTaskGraph(int N, const TaskModel& model, unsigned int seed) {
+    std::mt19937 engine(seed);
+    TaskGraph taskGraph(true);
+    taskGraph.tasks.reserve(N);
+    if (N > 0) addSeriesParallel(N, taskGraph, model, engine);
+
+    const int desiredTime = getDesiredTime(taskGraph);
+    return std::make_pair(std::move(taskGraph), desiredTime);
+}
+
+std::pair<TaskGraph, int> generateChainsTaskGraph(int chains, int length, const TaskModel& model, unsigned int seed) {
+    std::mt19937 engine(seed);
+    TaskGraph taskGraph(true);
+    taskGraph.tasks.reserve(chains * length);
+    for (int chain = 0; chain < chains; chain++) {
+        for (int n = 0; n < length; n++) {
+            addRandomTask(taskGraph, model, engine);
+            const int id = taskGraph.tasks.size() - 1;
+            if (n > 0) addRandomTransfer(taskGraph, id - 1, id, model, engine);
+        }
+    }
+
+    const int desiredTime = getDesiredTime(taskGraph);
+    return std::make_pair(std::move(taskGraph), desiredTime);
+}
+
+std::pair<TaskGraph, int> generateTreeTaskGraph(int N, bool outTree, const TaskModel& model, unsigned int seed) {
+    std::mt19937 engine(seed);
+    TaskGraph taskGraph(true);
+    taskGraph.tasks.reserve(N);
+    for (int n = 0; n < N; n++) addRandomTask(taskGraph, model, engine);
+    for (int n = 1; n < N; n++) {
+        const int other = getRandomUniformInt(engine, 0, n - 1);
+        if (outTree) addRandomTransfer(taskGraph, other, n, model, engine);
+        else addRandomTransfer(taskGraph, N - 1 - n, N - 1 - other, model, engine);
+    }
+
+    const int desiredTime = getDesiredTime(taskGraph);
+    return std::make_pair(std::move(taskGraph), desiredTime);
+}
+
+std::optional<std::pair<TaskGraph, int>> generateTaskGraph(std::string_view spec) {
+    std::vector<std::string_view> fields;
+    while (true) {
+        const auto colon = spec.find(':');
+        fields.push_back(spec.substr(0, colon));
+        if (colon == std::string_view::npos) break;
+        spec.remove_prefix(colon + 1);
+    }
+    const auto parse = [&fields](unsigned int index, auto& value){
+        const auto field = fields[index];
+        const auto [end, error] = std::from_chars(field.data(), field.data() + field.size(), value);
+        return error == std::errc() && end == field.data() + field.size();
+    };
+    // The parameters of the generator and an optional seed
+    int first = 0, second = 0, policies = 0;
+    float connectivity = 0.0f;
+    unsigned int seed = 302;
+    const auto parseFields = [&](int ints, bool withConnectivity){
+        const unsigned int count = 1 + ints + withConnectivity;
+        if (fields.size() != count && fields.size() != count + 1) return false;
+        int* const values[] = { &first, &second };
+        for (int i = 0; i + 1 < ints; i++) {
+            if (!parse(1 + i, *values[i]) || *values[i] <= 0) return false;
+        }
+        if (!parse(ints, policies) || policies <= 0) return false;
+        if (withConnectivity && (!parse(ints + 1, connectivity) || connectivity < 0.0f || connectivity > 1.0f)) {
+            return false;
+        }
+        return fields.size() == count || parse(count, seed);
+    };
+    const int lowTime = 3, highTime = 10;
+    const int lowVolume = 1, highVolume = 3;
+    const auto model = [&policies](){ return TaskModel{ policies, lowTime, highTime, lowVolume, highVolume }; };
+
+    const auto name = fields.front();
+    if (name == "random" && parseFields(2, true)) {
+        std::mt19937 engine(seed);
+        return generateRandomTaskGraph(first, policies, connectivity, lowTime, highTime, lowVolume, highVolume, engine);
+    }
+    if (name == "layered" && parseFields(3, true)) {
+        return generateLayeredTaskGraph(first, second, connectivity, model(), seed);
+    }
+    if (name == "forkjoin" && parseFields(3, false)) return generateForkJoinTaskGraph(first, second, model(), seed);
+    if (name == "seriesparallel" && parseFields(2, false)) return generateSeriesParallelTaskGraph(first, model(), seed);
+    if (name == "chains" && parseFields(3, false)) return generateChainsTaskGraph(first, second, model(), seed);
+    if (name == "outtree" && parseFields(2, false)) return generateTreeTaskGraph(first, true, model(), seed);
+    if (name == "intree" && parseFields(2, false)) return generateTreeTaskGraph(first, false, model(), seed);
+    return std::nullopt;
+}
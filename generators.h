@@ -0,0 +1,75 @@
+#pragma once
+
+#include <random>
+#include <utility>
+#include <optional>
+#include <string_view>
+#include "taskGraph.h"
+
+
+// [signed, unsigned]: short, int, long, long long
+// [low, high]
+template<typename T = int>
+T getRandomUniformInt(std::mt19937& engine, T low, T high) {
+    std::uniform_int_distribution<T> dist(low, high);
+    return dist(engine);
+}
+
+// What all the generators share: the number of policies and the ranges of
+// the weight on the slowest policy and of the transfer volumes
+struct TaskModel {
+    int policies;
+    int lowTime, highTime;
+    int lowVolume, highVolume;
+};
+
+// The weight/energy model of all the generators: every faster policy takes
+// SPEEDUP_WEIGHT_MAGNIFIER of the time and SPEEDUP_ENERGY_MAGNIFIER times the energy
+void addRandomTask(TaskGraph& taskGraph, const TaskModel& model, std::mt19937& engine);
+
+void addRandomTransfer(TaskGraph& taskGraph, int src, int dst, const TaskModel& model, std::mt19937& engine);
+
+// Halfway between the critical times on the fastest and on the slowest policies.
+// Leaves the Tasks on the fastest policy.
+int getDesiredTime(TaskGraph& taskGraph);
+// Of the Tasks of the CompactTaskGraph, which may be blank
+int getDesiredTime(TaskGraph& taskGraph, const CompactTaskGraph& compactTaskGraph);
+// Of a graph that only the CompactTaskGraph holds
+int getDesiredTime(const CompactTaskGraph& compactTaskGraph);
+
+// There is no shared engine, so that every instance is determined by its own
+// engine whatever else runs, and in whichever thread
+std::pair<TaskGraph, int> generateRandomTaskGraph(int N, int policies, float connectivity,
+        int lowTime, int highTime, int lowVolume, int highVolume, std::mt19937& engine) noexcept;
+
+// depth layers of width Tasks. Every Task has a random parent in the previous
+// layer, and is linked to each other Task of that layer with probability connectivity.
+std::pair<TaskGraph, int> generateLayeredTaskGraph(int width, int depth, float connectivity,
+        const TaskModel& model, unsigned int seed);
+
+// stages of branches parallel Tasks, each stage between a fork and a join
+// Task (the join of a stage is the fork of the next one)
+std::pair<TaskGraph, int> generateForkJoinTaskGraph(int branches, int stages,
+        const TaskModel& model, unsigned int seed);
+
+// <entry, exit> of a random series-parallel graph of size Tasks. The sizes are
+// split no worse than 1:3, so the recursion is O(log size) deep.
+std::pair<int, int> addSeriesParallel(int size, TaskGraph& taskGraph, const TaskModel& model, std::mt19937& engine);
+
+std::pair<TaskGraph, int> generateSeriesParallelTaskGraph(int N, const TaskModel& model, unsigned int seed);
+
+// chains independent chains of length Tasks
+std::pair<TaskGraph, int> generateChainsTaskGraph(int chains, int length, const TaskModel& model, unsigned int seed);
+
+// A random recursive tree: every Task but the root has a random parent among
+// the Tasks before it. The in-tree is the same with every transfer reversed,
+// so everything flows into a single sink.
+std::pair<TaskGraph, int> generateTreeTaskGraph(int N, bool outTree, const TaskModel& model, unsigned int seed);
+
+// A generator spec: name:parameters[:seed], with the weights and volumes of
+// the demo (times 3-10, volumes 1-3):
+//   random:N:policies:connectivity     layered:width:depth:policies:connectivity
+//   forkjoin:branches:stages:policies  seriesparallel:N:policies
+//   chains:chains:length:policies      outtree:N:policies    intree:N:policies
+// <taskGraph, desired time>, or nothing if the spec is not one of these
+std::optional<std::pair<TaskGraph, int>> generateTaskGraph(std::string_view spec);
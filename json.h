@@ -0,0 +1,30 @@
+#pragma once
+
+#include <iostream>
+#include <string_view>
+
+
+// A JSON string literal of the text: the quote, the backslash and every
+// control character escaped, the usual ones by name and the rest as \u00XX
+inline void writeJsonString(std::ostream& os, std::string_view text) {
+    static constexpr char HEX_DIGITS[] = "0123456789abcdef";
+    os << '"';
+    for (char c : text) {
+        switch (c) {
+            case '"': os << "\\\""; break;
+            case '\\': os << "\\\\"; break;
+            case '\b': os << "\\b"; break;
+            case '\f': os << "\\f"; break;
+            case '\n': os << "\\n"; break;
+            case '\r': os << "\\r"; break;
+            case '\t': os << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    os << "\\u00" << HEX_DIGITS[c >> 4] << HEX_DIGITS[c & 0xf];
+                } else {
+                    os << c;
+                }
+        }
+    }
+    os << '"';
+}
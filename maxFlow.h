@@ -0,0 +1,107 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+
+
+// Dinic's maximum flow, without recursion, keeping its storage between runs
+struct MaxFlow {
+    static constexpr long long UNBOUNDED = std::numeric_limits<long long>::max() / 4;
+
+    struct Edge {
+        int to;
+        long long capacity; // residual
+        int next; // of the same node
+    };
+    std::vector<Edge> edges; // an edge and its reverse are at 2i and 2i + 1
+    std::vector<int> firstEdge;
+    std::vector<int> level;
+    std::vector<int> currentEdge;
+    std::vector<int> path; // of edges
+
+    void reset(int nodesCount) {
+        edges.clear();
+        firstEdge.assign(nodesCount, -1);
+    }
+
+    void addEdge(int from, int to, long long capacity) {
+        edges.push_back({ to, capacity, firstEdge[from] });
+        firstEdge[from] = edges.size() - 1;
+        edges.push_back({ from, 0, firstEdge[to] });
+        firstEdge[to] = edges.size() - 1;
+    }
+
+    // Stops early once the flow reaches limit, then it is only known to be >= limit
+    long long run(int source, int sink, long long limit = UNBOUNDED) {
+        long long flow = 0;
+        while (flow < limit && buildLevels(source, sink)) {
+            currentEdge = firstEdge;
+            flow += blockingFlow(source, sink, limit - flow);
+        }
+        return flow;
+    }
+
+    // After run(): whether the node is on the source side of a minimum cut
+    bool onSourceSide(int node) const noexcept { return level[node] != -1; }
+
+private:
+    bool buildLevels(int source, int sink) {
+        level.assign(firstEdge.size(), -1);
+        std::vector<int>& queue = path; // free between the phases
+        queue.clear();
+        queue.push_back(source);
+        level[source] = 0;
+        for (unsigned int i = 0; i < queue.size(); i++) {
+            const int node = queue[i];
+            for (int e = firstEdge[node]; e != -1; e = edges[e].next) {
+                const int to = edges[e].to;
+                if (edges[e].capacity > 0 && level[to] == -1) {
+                    level[to] = level[node] + 1;
+                    queue.push_back(to);
+                }
+            }
+        }
+        return level[sink] != -1;
+    }
+
+    long long blockingFlow(int source, int sink, long long limit) {
+        long long flow = 0;
+        path.clear();
+        int node = source;
+        while (flow < limit) {
+            if (node == sink) {
+                long long pushed = limit - flow;
+                for (int e : path) pushed = std::min(pushed, edges[e].capacity);
+                unsigned int firstSaturated = path.size();
+                for (unsigned int i = 0; i < path.size(); i++) {
+                    edges[path[i]].capacity -= pushed;
+                    edges[path[i] ^ 1].capacity += pushed;
+                    if (edges[path[i]].capacity == 0 && firstSaturated == path.size()) firstSaturated = i;
+                }
+                flow += pushed;
+                // Continue from the tail of the first saturated edge
+                path.resize(firstSaturated);
+                node = path.empty() ? source : edges[path.back()].to;
+                continue;
+            }
+
+            int& e = currentEdge[node];
+            while (e != -1 && (edges[e].capacity == 0 || level[edges[e].to] != level[node] + 1)) e = edges[e].next;
+            if (e != -1) {
+                path.push_back(e);
+                node = edges[e].to;
+                continue;
+            }
+
+            // A dead end, never to be entered again in this phase
+            if (node == source) break;
+            level[node] = -1;
+            const int back = path.back();
+            path.pop_back();
+            node = edges[back ^ 1].to;
+            currentEdge[node] = edges[currentEdge[node]].next;
+        }
+        return flow;
+    }
+};
@@ -0,0 +1,42 @@
+#include "network.h"
+
+#include <charconv>
+
+
+std::optional<NetworkModel> parseNetworkModel(std::string_view spec) {
+    const auto parsePositive = [](std::string_view text, int& value){
+        const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+        return error == std::errc() && end == text.data() + text.size() && value > 0;
+    };
+    NetworkModel model;
+    const auto colon = spec.find(':');
+    const std::string_view name = spec.substr(0, colon);
+    if (name == "ideal") model.topology = Topology::Ideal;
+    else if (name == "bus") model.topology = Topology::Bus;
+    else if (name == "crossbar") model.topology = Topology::Crossbar;
+    else if (name == "ring") model.topology = Topology::Ring;
+    else if (name == "mesh") model.topology = Topology::Mesh;
+    else return std::nullopt;
+
+    if (colon != std::string_view::npos) {
+        std::string_view bandwidths = spec.substr(colon + 1);
+        model.bandwidths.clear();
+        while (!bandwidths.empty()) {
+            const auto comma = bandwidths.find(',');
+            std::string_view item = bandwidths.substr(0, comma);
+            bandwidths = comma == std::string_view::npos ? std::string_view() : bandwidths.substr(comma + 1);
+
+            int count = 1;
+            const auto times = item.find('x');
+            if (times != std::string_view::npos) {
+                if (!parsePositive(item.substr(times + 1), count)) return std::nullopt;
+                item = item.substr(0, times);
+            }
+            int bandwidth;
+            if (!parsePositive(item, bandwidth)) return std::nullopt;
+            model.bandwidths.insert(model.bandwidths.end(), count, bandwidth);
+        }
+        if (model.bandwidths.empty()) return std::nullopt;
+    }
+    return { model };
+}
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include "freeSlots.h"
+
+
+enum class Topology {
+    Ideal, // every transfer on its own wire, never waiting
+    Bus, // one link shared by all the cores
+    Crossbar, // a link out of and a link into every core
+    Ring, // a link each way between the neighbours, along the shorter way round
+    Mesh // a square grid of links each way, X then Y routing
+};
+
+struct NetworkModel {
+    Topology topology = Topology::Ideal;
+    // Per link id, in volume per unit of time; the last one for the rest too
+    std::vector<int> bandwidths{ 1 };
+};
+
+// ideal, bus, crossbar, ring or mesh[:bandwidth[xCount],...], e.g. ring:4x7,1,4
+std::optional<NetworkModel> parseNetworkModel(std::string_view spec);
+
+// The fits per link and duration, and the starts per source of transfers
+// over the routes searched, valid while the links stay as they are
+struct TransferCache {
+    struct Fit {
+        unsigned int stamp = 0; // valid while it is the cache's
+        int from, fit, slotEnd;
+    };
+    struct Start {
+        unsigned int stamp = 0;
+        int duration, time;
+    };
+    std::vector<int> durations; // of the rows of fits
+    std::vector<Fit> fits; // [row][link]
+    std::vector<Start> starts; // [source][link]
+    int linksCount = 0;
+    unsigned int stamp = 0;
+
+    // Forgets everything, keeping the storage
+    void reset(int linksCount) noexcept {
+        this->linksCount = linksCount;
+        durations.clear();
+        stamp++;
+    }
+
+    Fit* fitsOf(int duration) {
+        int row = 0;
+        while (row < static_cast<int>(durations.size()) && durations[row] != duration) row++;
+        if (row == static_cast<int>(durations.size())) {
+            durations.push_back(duration);
+            if (fits.size() < durations.size() * linksCount) fits.resize(durations.size() * linksCount);
+        }
+        return fits.data() + row * linksCount;
+    }
+
+    Start* startsOf(int source) {
+        if (starts.size() < static_cast<size_t>(source + 1) * linksCount) starts.resize((source + 1) * linksCount);
+        return starts.data() + source * linksCount;
+    }
+};
+
+// The links between the cores. A transfer holds its whole route at once
+struct Network {
+    NetworkModel model;
+    std::vector<FreeSlots> links;
+    std::vector<int> bandwidthOf; // of every link
+    int fastestBandwidth = 1;
+    int coresCount = 0;
+    int meshWidth = 1;
+
+    // Back to free links for coresCount cores, keeping the storage
+    void reset(int coresCount) {
+        this->coresCount = coresCount;
+        meshWidth = 1;
+        while (meshWidth * meshWidth < coresCount) meshWidth++;
+        int linksCount = 0;
+        switch (model.topology) {
+            case Topology::Ideal: linksCount = 0; break;
+            case Topology::Bus: linksCount = 1; break;
+            case Topology::Crossbar: linksCount = 2 * coresCount; break;
+            case Topology::Ring: linksCount = 2 * coresCount; break;
+            // The last row may be short, its missing cores being plain routers
+            case Topology::Mesh: linksCount = 4 * meshWidth * ((coresCount + meshWidth - 1) / meshWidth); break;
+        }
+        links.resize(linksCount);
+        for (auto& link : links) link.clear();
+        const auto& bandwidths = model.bandwidths;
+        bandwidthOf.resize(linksCount);
+        for (int link = 0; link < linksCount; link++) {
+            bandwidthOf[link] = bandwidths[std::min<size_t>(link, bandwidths.size() - 1)];
+        }
+        fastestBandwidth = linksCount > 0 ? *std::max_element(bandwidthOf.begin(), bandwidthOf.end())
+            : *std::max_element(bandwidths.begin(), bandwidths.end());
+    }
+
+    bool ideal() const noexcept { return model.topology == Topology::Ideal; }
+
+    // The least time a transfer of the volume takes, over the fastest link,
+    // which is what it takes on the ideal network
+    int durationOf(int volume) const noexcept { return (volume + fastestBandwidth - 1) / fastestBandwidth; }
+    // Over the route, held all at once, so at the pace of its slowest link
+    int durationOf(const std::vector<int>& linkIds, int volume) const noexcept {
+        int bandwidth = fastestBandwidth;
+        for (int link : linkIds) bandwidth = std::min(bandwidth, bandwidthOf[link]);
+        return (volume + bandwidth - 1) / bandwidth;
+    }
+
+    // The links from the src core to the dst core, in order. The route up to
+    // any of its links is the same whatever the dst, as TransferCache needs
+    void route(int src, int dst, std::vector<int>& linkIds) const {
+        linkIds.clear();
+        if (src == dst) return;
+        switch (model.topology) {
+            case Topology::Ideal:
+                break;
+            case Topology::Bus:
+                linkIds.push_back(0);
+                break;
+            case Topology::Crossbar:
+                linkIds.push_back(src);
+                linkIds.push_back(coresCount + dst);
+                break;
+            case Topology::Ring: {
+                // Link i goes from core i to i + 1, link coresCount + i from i + 1 to i
+                const int clockwise = (dst - src + coresCount) % coresCount;
+                if (clockwise <= coresCount - clockwise) {
+                    for (int core = src; core != dst; core = (core + 1) % coresCount) linkIds.push_back(core);
+                } else {
+                    for (int core = src; core != dst; core = (core - 1 + coresCount) % coresCount) {
+                        linkIds.push_back(coresCount + (core - 1 + coresCount) % coresCount);
+                    }
+                }
+                break;
+            }
+            case Topology::Mesh: {
+                // The link 4 * core + direction leaves the core: 0 east, 1 west, 2 south, 3 north
+                int x = src % meshWidth, y = src / meshWidth;
+                const int dstX = dst % meshWidth, dstY = dst / meshWidth;
+                for (; x != dstX; x += x < dstX ? 1 : -1) linkIds.push_back(4 * (y * meshWidth + x) + (x < dstX ? 0 : 1));
+                for (; y != dstY; y += y < dstY ? 1 : -1) linkIds.push_back(4 * (y * meshWidth + x) + (y < dstY ? 2 : 3));
+                break;
+            }
+        }
+    }
+
+    // The earliest time from let when the whole route is free for the duration,
+    // or some time past giveUpAfter
+    int earliestTransfer(const std::vector<int>& linkIds, int duration, int let,
+            int giveUpAfter = std::numeric_limits<int>::max()) const noexcept {
+        return earliestTransferBy(linkIds.data(), linkIds.size(), let, giveUpAfter,
+                [this, duration](int link, int time){ return links[link].earliestFit(duration, time); });
+    }
+    // The same, going on from what the cache has for the source
+    int earliestTransfer(const std::vector<int>& linkIds, int duration, int let, int giveUpAfter,
+            TransferCache& cache, int source) const {
+        TransferCache::Fit* const fits = cache.fitsOf(duration);
+        TransferCache::Start* const starts = cache.startsOf(source);
+        const auto fitOf = [this, duration, fits, &cache](int link, int time){
+            auto& cached = fits[link];
+            if (cached.stamp == cache.stamp && cached.from <= time) {
+                if (time <= cached.fit) return cached.fit;
+                if (time <= cached.slotEnd - duration) return time;
+            }
+            const auto [fit, slotEnd] = links[link].earliestWindow(duration, time);
+            cached = { cache.stamp, time, fit, slotEnd };
+            return fit;
+        };
+
+        const int linksCount = linkIds.size();
+        const auto known = [&cache, duration](const TransferCache::Start& start){
+            return start.stamp == cache.stamp && start.duration == duration;
+        };
+        int searched = linksCount;
+        while (searched > 0 && !known(starts[linkIds[searched - 1]])) searched--;
+        int time = searched > 0 ? starts[linkIds[searched - 1]].time : let;
+        for (; searched < linksCount && time <= giveUpAfter; searched++) {
+            const int fit = fitOf(linkIds[searched], time);
+            if (fit != time) time = earliestTransferBy(linkIds.data(), searched + 1, fit, giveUpAfter, fitOf);
+            // Only the starts that were not given up on are exact
+            if (time <= giveUpAfter) starts[linkIds[searched]] = { cache.stamp, duration, time };
+        }
+        return time;
+    }
+
+    void book(const std::vector<int>& linkIds, int start, int finish) {
+        if (start == finish) return;
+        for (int link : linkIds) links[link].occupy(start, finish);
+    }
+
+private:
+    template<typename FitOf>
+    static int earliestTransferBy(const int* linkIds, int linksCount, int let, int giveUpAfter, FitOf&& fitOf) {
+        int time = let;
+        for (int link = 0, agreeing = 0; agreeing < linksCount && time <= giveUpAfter; link = (link + 1) % linksCount) {
+            const int fit = fitOf(linkIds[link], time);
+            agreeing = fit == time ? agreeing + 1 : 1;
+            time = fit;
+        }
+        return time;
+    }
+};
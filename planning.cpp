@@ -0,0 +1,724 @@
+#include "planning.h"
+
+#include <algorithm>
+#include <limits>
+#include <functional>
+#include <charconv>
+
+
+std::optional<std::vector<CoreProfile>> parseCoreProfiles(std::string_view spec) {
+    const auto parsePositive = [](std::string_view text, int& value){
+        const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+        return error == std::errc() && end == text.data() + text.size() && value > 0;
+    };
+    std::vector<CoreProfile> profiles;
+    while (!spec.empty()) {
+        const auto comma = spec.find(',');
+        std::string_view item = spec.substr(0, comma);
+        spec = comma == std::string_view::npos ? std::string_view() : spec.substr(comma + 1);
+
+        int count = 1;
+        const auto times = item.find('x');
+        if (times != std::string_view::npos) {
+            if (!parsePositive(item.substr(times + 1), count)) return std::nullopt;
+            item = item.substr(0, times);
+        }
+        const auto colon = item.find(':');
+        if (colon == std::string_view::npos) return std::nullopt;
+        CoreProfile profile;
+        if (!parsePositive(item.substr(0, colon), profile.speedPercent)) return std::nullopt;
+        if (!parsePositive(item.substr(colon + 1), profile.energyPercent)) return std::nullopt;
+        profiles.insert(profiles.end(), count, profile);
+    }
+    if (profiles.empty()) return std::nullopt;
+    return { profiles };
+}
+
+std::optional<Scheduler> parseScheduler(std::string_view name) noexcept {
+    if (name == "delta") return { Scheduler::Delta };
+    if (name == "heft") return { Scheduler::Heft };
+    if (name == "peft") return { Scheduler::Peft };
+    return std::nullopt;
+}
+
+std::optional<std::vector<Scheduler>> parseSchedulers(std::string_view list) {
+    if (list == "best") return { { Scheduler::Delta, Scheduler::Heft, Scheduler::Peft } };
+    std::vector<Scheduler> schedulers;
+    while (true) {
+        const auto comma = list.find(',');
+        const auto scheduler = parseScheduler(list.substr(0, comma));
+        if (!scheduler) return std::nullopt;
+        schedulers.push_back(*scheduler);
+        if (comma == std::string_view::npos) return { schedulers };
+        list = list.substr(comma + 1);
+    }
+}
+
+const char* nameOf(Scheduler scheduler) noexcept {
+    switch (scheduler) {
+        case Scheduler::Delta: return "delta";
+        case Scheduler::Heft: return "heft";
+        case Scheduler::Peft: return "peft";
+    }
+    return "";
+}
+
+PlanningStuff planning(const TaskGraph& taskGraph, const CompactTaskGraph& compactTaskGraph,
+        const std::vector<int>& rootTasks, int CORES_COUNT) {
+    PlanningStuff planningStuff;
+    planning(taskGraph, compactTaskGraph, rootTasks, CORES_COUNT, planningStuff);
+    return planningStuff;
+}
+
+void planning(const TaskGraph& taskGraph, const CompactTaskGraph& compactTaskGraph,
+        const std::vector<int>& rootTasks, int CORES_COUNT, PlanningStuff& planningStuff) {
+    const auto& schedulers = planningStuff.schedulers;
+    auto& makespanOf = planningStuff.makespanOf;
+    makespanOf.clear();
+    unsigned int best = 0;
+    for (unsigned int i = 0; i < schedulers.size(); i++) {
+        planning(taskGraph, compactTaskGraph, rootTasks, CORES_COUNT, planningStuff, schedulers[i]);
+        makespanOf.push_back(planningStuff.finishedAt());
+        if (makespanOf[i] < makespanOf[best]) best = i;
+    }
+    if (best + 1 != schedulers.size()) {
+        planning(taskGraph, compactTaskGraph, rootTasks, CORES_COUNT, planningStuff, schedulers[best]);
+    }
+    planningStuff.scheduler = schedulers[best];
+}
+
+// Replaying, the planning in planningStuff is kept up to the first Task that
+// may be planned differently and goes on from there
+void planningWith(const TaskGraph& taskGraph, const CompactTaskGraph& compactTaskGraph,
+        const std::vector<int>& rootTasks, int CORES_COUNT, PlanningStuff& planningStuff, Scheduler scheduler,
+        bool replay) {
+    const ScopedTimer timer(planningStuff.trace, replay ? "replanning" : "planning");
+    const int tasksCount = compactTaskGraph.tasksCount;
+    auto& workspace = planningStuff.workspace;
+    auto& parentsLeft = workspace.parentsLeft;
+    parentsLeft.resize(tasksCount);
+    for (int id = 0; id < tasksCount; id++) {
+        parentsLeft[id] = compactTaskGraph.predecessorsOf(id).size();
+    }
+    auto& processors = planningStuff.processors;
+    processors.resize(CORES_COUNT);
+    auto& network = planningStuff.network;
+    network.reset(CORES_COUNT); // before the ranks, which take the durations of the transfers
+    auto& arrivalOf = planningStuff.arrivalOf;
+    const auto edgeIndexOf = [&compactTaskGraph](const CompactTaskGraph::Edge& edge){
+        return static_cast<int>(&edge - compactTaskGraph.predecessors);
+    };
+    // <core, finish time>
+    auto& assignmentOf = planningStuff.assignmentOf;
+    auto& startOf = planningStuff.startOf;
+    if (!replay) {
+        arrivalOf.assign(compactTaskGraph.edgesCount(), 0);
+        assignmentOf.assign(tasksCount, std::make_pair(-1, -1));
+        startOf.assign(tasksCount, -1);
+    }
+
+    // The cores of the same profile form a class, and the weight of every Task
+    // on every class is worked out up front, so a Task only gathers its row
+    auto& classProfiles = workspace.classProfiles;
+    auto& classOf = workspace.classOf;
+    classProfiles.clear();
+    classOf.resize(CORES_COUNT);
+    for (int core = 0; core < CORES_COUNT; core++) {
+        const auto& profile = processors[core].profile;
+        const auto it = std::find(classProfiles.begin(), classProfiles.end(), profile);
+        classOf[core] = it - classProfiles.begin();
+        if (it == classProfiles.end()) classProfiles.push_back(profile);
+    }
+    const int classesCount = classProfiles.size();
+    auto& weightOf = workspace.weightOf; // nominal
+    auto& weightOnClass = workspace.weightOnClass;
+    weightOf.resize(tasksCount);
+    weightOnClass.resize(tasksCount * classesCount);
+    for (int id = 0; id < tasksCount; id++) {
+        weightOf[id] = compactTaskGraph.weight(id, taskGraph.tasks[id].policy);
+        for (int c = 0; c < classesCount; c++) weightOnClass[id * classesCount + c] = classProfiles[c].weightOf(weightOf[id]);
+    }
+    const auto weightOn = [&weightOnClass, &classOf, classesCount](int id, unsigned int core){
+        return weightOnClass[id * classesCount + classOf[core]];
+    };
+
+    // The priorities, and with PEFT the optimistic cost table: per Task and
+    // class the least time from its finish to the end of the graph, with every
+    // later Task on its best core and a transfer wherever that core changes.
+    // Both go from the sinks up in O((V + E) * classes). The ranks are sums
+    // over the cores rather than means, so they stay whole.
+    auto& priorityOf = workspace.priorityOf;
+    auto& optimisticOnClass = workspace.optimisticOnClass;
+    priorityOf.resize(tasksCount);
+    optimisticOnClass.clear();
+    if (scheduler == Scheduler::Delta) {
+        for (int id = 0; id < tasksCount; id++) priorityOf[id] = taskGraph.tasks[id].delta();
+    } else {
+        auto& classSize = workspace.classSize;
+        classSize.assign(classesCount, 0);
+        for (int core = 0; core < CORES_COUNT; core++) classSize[classOf[core]]++;
+        auto& topologicalOrder = workspace.topologicalOrder;
+        auto& left = workspace.left;
+        topologicalOrder.assign(rootTasks.begin(), rootTasks.end());
+        left.assign(parentsLeft.begin(), parentsLeft.end());
+        for (unsigned int i = 0; i < topologicalOrder.size(); i++) {
+            for (const auto& [dst, _volume] : compactTaskGraph.successorsOf(topologicalOrder[i])) {
+                if (--left[dst] == 0) topologicalOrder.push_back(dst);
+            }
+        }
+        if (scheduler == Scheduler::Peft) optimisticOnClass.assign(tasksCount * classesCount, 0);
+        for (auto it = topologicalOrder.rbegin(); it != topologicalOrder.rend(); it++) {
+            const int id = *it;
+            const int* const weight = weightOnClass.data() + id * classesCount;
+            long long rank = 0;
+            if (scheduler == Scheduler::Heft) { // the mean weight plus the longest mean path after it
+                for (const auto& [dst, volume] : compactTaskGraph.successorsOf(id)) {
+                    rank = std::max(rank, -priorityOf[dst] + static_cast<long long>(CORES_COUNT) * network.durationOf(volume));
+                }
+                for (int c = 0; c < classesCount; c++) rank += static_cast<long long>(classSize[c]) * weight[c];
+            } else { // the mean optimistic cost
+                int* const optimistic = optimisticOnClass.data() + id * classesCount;
+                for (const auto& [dst, volume] : compactTaskGraph.successorsOf(id)) {
+                    // The Target on a core of the class, or on the best core after a transfer
+                    const int* const dstOptimistic = optimisticOnClass.data() + dst * classesCount;
+                    const int* const dstWeight = weightOnClass.data() + dst * classesCount;
+                    int elsewhere = std::numeric_limits<int>::max();
+                    for (int c = 0; c < classesCount; c++) elsewhere = std::min(elsewhere, dstOptimistic[c] + dstWeight[c]);
+                    elsewhere += network.durationOf(volume);
+                    for (int c = 0; c < classesCount; c++) {
+                        optimistic[c] = std::max(optimistic[c], std::min(dstOptimistic[c] + dstWeight[c], elsewhere));
+                    }
+                }
+                for (int c = 0; c < classesCount; c++) rank += static_cast<long long>(classSize[c]) * optimistic[c];
+            }
+            priorityOf[id] = -rank; // the highest rank first
+        }
+    }
+    const auto& priorityBiasOf = planningStuff.priorityBiasOf;
+    if (!priorityBiasOf.empty()) {
+        for (int id = 0; id < tasksCount; id++) priorityOf[id] += priorityBiasOf[id];
+    }
+    const auto& pinnedCoreOf = planningStuff.pinnedCoreOf;
+    const auto pinOf = [](const std::vector<int>& pins, int id){ return pins.empty() ? -1 : pins[id]; };
+
+    // The pushes and pops of a std::priority_queue, on the storage of the workspace
+    auto& readyTasks = workspace.readyTasks;
+    readyTasks.clear();
+    int readyCount = 0;
+    const auto makeReady = [&readyTasks, &readyCount, &priorityOf](int id){
+        readyTasks.emplace_back(priorityOf[id], readyCount++, id);
+        std::push_heap(readyTasks.begin(), readyTasks.end(), std::greater<ReadyTask>());
+    };
+    const auto takeMostUrgent = [&readyTasks](){
+        std::pop_heap(readyTasks.begin(), readyTasks.end(), std::greater<ReadyTask>());
+        const int id = readyTasks.back().id;
+        readyTasks.pop_back();
+        return id;
+    };
+    for (int id : rootTasks) makeReady(id);
+
+    // Replaying, the planning is kept for as long as the most urgent ready Task
+    // under the new priorities is the one planned next before, with the same
+    // weight, optimistic cost and pin, as it is then placed the same way. Only the
+    // ready queue is replayed that far, which leaves it as the planning needs it.
+    // The timelines are appended to in the planning order, so what is kept of
+    // them is a prefix, and the free slots are rebuilt from it.
+    auto& plannedOrder = planningStuff.plannedOrder;
+    int from = 0;
+    if (replay) {
+        const auto& plannedWeightOf = planningStuff.plannedWeightOf;
+        const auto& plannedOptimisticOnClass = planningStuff.plannedOptimisticOnClass;
+        const auto unchanged = [&](int id){
+            if (weightOf[id] != plannedWeightOf[id]) return false;
+            if (pinOf(pinnedCoreOf, id) != pinOf(planningStuff.plannedPinnedCoreOf, id)) return false;
+            if (optimisticOnClass.empty()) return true;
+            const auto row = optimisticOnClass.begin() + id * classesCount;
+            return std::equal(row, row + classesCount, plannedOptimisticOnClass.begin() + id * classesCount);
+        };
+        while (from < tasksCount && readyTasks.front().id == plannedOrder[from] && unchanged(plannedOrder[from])) {
+            takeMostUrgent();
+            for (const auto& [id, _] : compactTaskGraph.successorsOf(plannedOrder[from])) {
+                if (--parentsLeft[id] == 0) makeReady(id);
+            }
+            from++;
+        }
+    }
+    auto& stepOf = workspace.stepOf;
+    if (from > 0) {
+        stepOf.resize(tasksCount);
+        for (int step = 0; step < tasksCount; step++) stepOf[plannedOrder[step]] = step;
+    }
+    plannedOrder.resize(from);
+
+    // Per-core values in contiguous arrays, so that the loops over the cores vectorize
+    auto& coreFinishedAt = workspace.coreFinishedAt; // the finishedAt() of every processor
+    auto& route = workspace.route;
+    coreFinishedAt.assign(CORES_COUNT, 0);
+    for (int core = 0; core < CORES_COUNT; core++) {
+        auto& processor = processors[core];
+        if (from == 0) {
+            processor.clear();
+            continue;
+        }
+        auto& processing = processor.processingTimeline;
+        processing.erase(std::find_if(processing.begin(), processing.end(),
+                    [&stepOf, from](const auto& event){ return stepOf[event.taskId] >= from; }), processing.end());
+        auto& transfers = processor.transferTimeline;
+        transfers.erase(std::find_if(transfers.begin(), transfers.end(),
+                    [&stepOf, from](const auto& event){ return stepOf[event.dst] >= from; }), transfers.end());
+        processor.freeSlots.clear();
+        for (const auto& event : processing) processor.freeSlots.occupy(event.start, event.finish);
+        for (const auto& event : transfers) {
+            network.route(core, assignmentOf[event.dst].first, route);
+            network.book(route, event.start, event.finish());
+        }
+        coreFinishedAt[core] = processor.finishedAt();
+    }
+
+    int probes = 0; // of availableAt(), for the trace
+    auto& weightOnCore = workspace.weightOnCore;
+    auto& optimisticOnCore = workspace.optimisticOnCore; // zero but with PEFT
+    auto& canFinishAt = workspace.canFinishAt; // plus optimisticOnCore, as the cores are compared by it
+    weightOnCore.resize(CORES_COUNT);
+    optimisticOnCore.assign(CORES_COUNT, 0);
+    canFinishAt.resize(CORES_COUNT);
+    const auto gatherWeights = [&weightOnClass, &optimisticOnClass, &classOf, &weightOnCore, &optimisticOnCore,
+            classesCount](int id){
+        const int* const row = weightOnClass.data() + id * classesCount;
+        const int coresCount = weightOnCore.size();
+        for (int core = 0; core < coresCount; core++) weightOnCore[core] = row[classOf[core]];
+        if (!optimisticOnClass.empty()) {
+            const int* const optimisticRow = optimisticOnClass.data() + id * classesCount;
+            for (int core = 0; core < coresCount; core++) optimisticOnCore[core] = optimisticRow[classOf[core]];
+        }
+        return std::make_pair(weightOnCore.data(), optimisticOnCore.data());
+    };
+
+    // We've found the most urgent Task among the ready ones.
+    // The data is ready on a core once the parents on the other cores have sent
+    // it: the latest arrival overall, except on the core of that arrival, where
+    // it is the latest arrival from any other core or the latest finish of a
+    // parent on that core. So O(parents + cores).
+    // A core that finishes by then can start right away, and only the cores busy
+    // past it (and still able to win) need their free slots searched.
+    // The first core with the earliest finish wins (HEFT's earliest finish time),
+    // which on identical cores is the one with the earliest start. With PEFT
+    // it is the least finish plus the optimistic cost of the rest.
+    const auto determineAssignmentCore = [&processors, &compactTaskGraph, &assignmentOf, &network,
+            &coreFinishedAt, &canFinishAt, &gatherWeights, &probes](int taskId){
+        int latest = 0, latestElsewhere = 0;
+        unsigned int latestCore = -1;
+        for (const auto& [parent, volume] : compactTaskGraph.predecessorsOf(taskId)) {
+            const auto [parentCore, parentFinishedAt] = assignmentOf[parent];
+            const int arrival = parentFinishedAt + network.durationOf(volume);
+            if (parentCore == latestCore) {
+                latest = std::max(latest, arrival);
+            } else if (arrival > latest) {
+                latestElsewhere = latest; // from a core other than parentCore
+                latest = arrival;
+                latestCore = parentCore;
+            } else {
+                latestElsewhere = std::max(latestElsewhere, arrival);
+            }
+        }
+        // The parents on the core of the latest arrival need no transfer, but
+        // their data is only there once they finish
+        for (const auto& [parent, _volume] : compactTaskGraph.predecessorsOf(taskId)) {
+            const auto [parentCore, parentFinishedAt] = assignmentOf[parent];
+            if (parentCore == latestCore) latestElsewhere = std::max(latestElsewhere, parentFinishedAt);
+        }
+        const int coresCount = canFinishAt.size();
+        const int* const finishedAt = coreFinishedAt.data();
+        const auto [weight, optimistic] = gatherWeights(taskId);
+        int* const finishAt = canFinishAt.data();
+        const auto dataReadyAt = [latest, latestElsewhere, latestCore](int core){
+            return static_cast<unsigned int>(core) == latestCore ? latestElsewhere : latest;
+        };
+
+        // Exact for the cores that finish by dataReadyAt, an upper bound for the rest.
+        // The simd pragmas (-fopenmp-simd) let -O2 vectorize with a remainder loop
+        #pragma omp simd
+        for (int core = 0; core < coresCount; core++) {
+            finishAt[core] = std::max(latest, finishedAt[core]) + weight[core] + optimistic[core];
+        }
+        if (latestCore < canFinishAt.size()) {
+            finishAt[latestCore] = std::max(latestElsewhere, finishedAt[latestCore]) + weight[latestCore]
+                + optimistic[latestCore];
+        }
+        int bestTime = std::numeric_limits<int>::max();
+        #pragma omp simd reduction(min:bestTime)
+        for (int core = 0; core < coresCount; core++) bestTime = finishAt[core] < bestTime ? finishAt[core] : bestTime;
+
+        for (int core = 0; core < coresCount; core++) {
+            const int readyAt = dataReadyAt(core);
+            if (finishedAt[core] <= readyAt || readyAt + weight[core] + optimistic[core] > bestTime) continue;
+            finishAt[core] = processors[core].availableAt(weight[core], readyAt) + weight[core] + optimistic[core];
+            bestTime = std::min(bestTime, finishAt[core]);
+            probes++;
+        }
+
+        unsigned int bestCore = 0;
+        while (finishAt[bestCore] != bestTime) bestCore++;
+        return std::make_pair(bestCore, bestTime - optimistic[bestCore] - weight[bestCore]);
+    };
+
+    // A Task pinned to a core starts there once its data is, which with
+    // contention the booking below works out again
+    const auto startOnCore = [&processors, &compactTaskGraph, &assignmentOf, &network, &weightOn, &probes](
+            int taskId, unsigned int core){
+        int readyAt = 0;
+        for (const auto& [parent, volume] : compactTaskGraph.predecessorsOf(taskId)) {
+            const auto [parentCore, parentFinishedAt] = assignmentOf[parent];
+            readyAt = std::max(readyAt, parentFinishedAt + (parentCore == core ? 0 : network.durationOf(volume)));
+        }
+        probes++;
+        return std::make_pair(core, processors[core].availableAt(weightOn(taskId, core), readyAt));
+    };
+
+    // With contention the transfers to a core wait for the links of their
+    // routes and go at the pace of the slowest one, so the data is ready no
+    // earlier than without waiting over the fastest link, and the Task
+    // finishes no earlier than on the core free after that. The cores are tried
+    // by that bound (plus the optimistic cost with PEFT), and once it exceeds
+    // the best one the rest cannot win.
+    // The choice is a heuristic: the transfers to one core are searched as if
+    // each were alone, so two of them may take the same window of a link. Only
+    // the chosen core gets them booked (bookTransfers()), which separates them
+    // and gives the actual arrivals, so another core may have finished the Task
+    // earlier. The candidates are a heap, so only those tried are ordered, and
+    // the searches of the routes to them share what they find through the cache.
+    auto& candidates = workspace.candidates; // <bound on the finish (plus optimistic cost), core>
+    auto& transferCache = workspace.transferCache;
+    const auto determineAssignmentCoreOverNetwork = [&processors, &compactTaskGraph, &assignmentOf, &gatherWeights,
+            &network, &route, &candidates, &transferCache, &probes, coresCount = CORES_COUNT](int taskId){
+        int latest = 0, latestElsewhere = 0;
+        unsigned int latestCore = -1;
+        for (const auto& [parent, volume] : compactTaskGraph.predecessorsOf(taskId)) {
+            const auto [parentCore, parentFinishedAt] = assignmentOf[parent];
+            const int arrival = parentFinishedAt + network.durationOf(volume);
+            if (parentCore == latestCore) {
+                latest = std::max(latest, arrival);
+            } else if (arrival > latest) {
+                latestElsewhere = latest;
+                latest = arrival;
+                latestCore = parentCore;
+            } else {
+                latestElsewhere = std::max(latestElsewhere, arrival);
+            }
+        }
+
+        const auto [weight, optimistic] = gatherWeights(taskId);
+        candidates.clear();
+        for (int core = 0; core < coresCount; core++) {
+            const int readyBound = static_cast<unsigned int>(core) == latestCore ? latestElsewhere : latest;
+            candidates.emplace_back(processors[core].availableAt(weight[core], readyBound) + weight[core]
+                    + optimistic[core], core);
+        }
+        std::make_heap(candidates.begin(), candidates.end(), std::greater<>());
+        probes += coresCount;
+        transferCache.reset(network.links.size());
+
+        unsigned int bestCore = 0;
+        int bestTime = std::numeric_limits<int>::max();
+        while (!candidates.empty()) {
+            std::pop_heap(candidates.begin(), candidates.end(), std::greater<>());
+            const auto [bound, core] = candidates.back();
+            candidates.pop_back();
+            if (bound > bestTime) break;
+            if (bound == bestTime && static_cast<unsigned int>(core) > bestCore) continue;
+            // Given up on as soon as the data cannot be there for the best finish
+            const int readyBy = bestTime - optimistic[core] - weight[core];
+            int readyAt = 0;
+            int source = 0; // the parents are the sources of the transfers in the cache
+            for (const auto& [parent, volume] : compactTaskGraph.predecessorsOf(taskId)) {
+                const auto [parentCore, parentFinishedAt] = assignmentOf[parent];
+                int arrival = parentFinishedAt;
+                if (parentCore != static_cast<unsigned int>(core)) {
+                    network.route(parentCore, core, route);
+                    const int duration = network.durationOf(route, volume);
+                    arrival = network.earliestTransfer(route, duration, parentFinishedAt, readyBy - duration,
+                            transferCache, source) + duration;
+                }
+                readyAt = std::max(readyAt, arrival);
+                if (readyAt > readyBy) break;
+                source++;
+            }
+            if (readyAt > readyBy) continue;
+            const int finishAt = processors[core].availableAt(weight[core], readyAt) + weight[core] + optimistic[core];
+            probes++;
+            if (finishAt < bestTime || (finishAt == bestTime && static_cast<unsigned int>(core) < bestCore)) {
+                bestTime = finishAt;
+                bestCore = core;
+            }
+        }
+        return std::make_pair(bestCore, bestTime - optimistic[bestCore] - weight[bestCore]);
+    };
+
+    // The transfers in the order their data is ready, each on the earliest
+    // free window of its route. <parent finish time, edge index>
+    auto& transfers = workspace.transfers;
+    const auto bookTransfers = [&processors, &compactTaskGraph, &assignmentOf, &network, &arrivalOf,
+            &route, &transfers, &edgeIndexOf](int taskId, unsigned int core){
+        transfers.clear();
+        int readyAt = 0;
+        for (const auto& edge : compactTaskGraph.predecessorsOf(taskId)) {
+            const auto [parentCore, parentFinish] = assignmentOf[edge.id];
+            if (parentCore == core) {
+                arrivalOf[edgeIndexOf(edge)] = parentFinish;
+                readyAt = std::max(readyAt, parentFinish);
+            } else {
+                transfers.emplace_back(parentFinish, edgeIndexOf(edge));
+            }
+        }
+        std::sort(transfers.begin(), transfers.end());
+        for (const auto& [parentFinish, edgeIndex] : transfers) {
+            const auto& [parent, volume] = compactTaskGraph.predecessors[edgeIndex];
+            const unsigned int parentCore = assignmentOf[parent].first;
+            network.route(parentCore, core, route);
+            const int duration = network.durationOf(route, volume);
+            const int start = network.earliestTransfer(route, duration, parentFinish);
+            network.book(route, start, start + duration);
+            processors[parentCore].transferTimeline.emplace_back(start, duration, parent, taskId);
+            arrivalOf[edgeIndex] = start + duration;
+            readyAt = std::max(readyAt, start + duration);
+        }
+        return readyAt;
+    };
+
+    while (!readyTasks.empty()) {
+        // Take most urgent Task (min delta = Late - Early)
+        const int taskToAssign = takeMostUrgent();
+
+        // Assign
+        const int pinnedCore = pinOf(pinnedCoreOf, taskToAssign);
+        auto [core, startTime] = pinnedCore != -1 ? startOnCore(taskToAssign, pinnedCore)
+            : network.ideal() ? determineAssignmentCore(taskToAssign) : determineAssignmentCoreOverNetwork(taskToAssign);
+        if (network.ideal()) {
+            for (const auto& edge : compactTaskGraph.predecessorsOf(taskToAssign)) {
+                const auto [parentCore, parentFinish] = assignmentOf[edge.id];
+                const int duration = network.durationOf(edge.volume);
+                arrivalOf[edgeIndexOf(edge)] = parentFinish + (core == parentCore ? 0 : duration);
+                if (core != parentCore) {
+                    processors[parentCore].transferTimeline.emplace_back(parentFinish, duration, edge.id, taskToAssign);
+                }
+            }
+        } else {
+            startTime = processors[core].availableAt(weightOn(taskToAssign, core), bookTransfers(taskToAssign, core));
+            probes++;
+        }
+        const int finishTime = startTime + weightOn(taskToAssign, core);
+        assignmentOf[taskToAssign] = std::make_pair(core, finishTime);
+        startOf[taskToAssign] = startTime;
+        processors[core].assign(startTime, finishTime, taskToAssign);
+        coreFinishedAt[core] = std::max(coreFinishedAt[core], finishTime);
+        plannedOrder.push_back(taskToAssign);
+
+        // Find new ready Tasks
+        for (const auto& [id, _] : compactTaskGraph.successorsOf(taskToAssign)) {
+            if (--parentsLeft[id] == 0) makeReady(id);
+        }
+    }
+
+    if (Trace* const trace = planningStuff.trace) {
+        trace->count(Trace::Counter::SchedulingPasses);
+        trace->count(Trace::Counter::AvailableAtProbes, probes);
+    }
+    planningStuff.scheduler = scheduler;
+    planningStuff.plannedWeightOf.assign(weightOf.begin(), weightOf.end());
+    planningStuff.plannedOptimisticOnClass.assign(optimisticOnClass.begin(), optimisticOnClass.end());
+    planningStuff.plannedPinnedCoreOf.assign(pinnedCoreOf.begin(), pinnedCoreOf.end());
+}
+
+void planning(const TaskGraph& taskGraph, const CompactTaskGraph& compactTaskGraph,
+        const std::vector<int>& rootTasks, int CORES_COUNT, PlanningStuff& planningStuff, Scheduler scheduler) {
+    planningWith(taskGraph, compactTaskGraph, rootTasks, CORES_COUNT, planningStuff, scheduler, false);
+}
+
+void replanning(const TaskGraph& taskGraph, const CompactTaskGraph& compactTaskGraph,
+        const std::vector<int>& rootTasks, int CORES_COUNT, PlanningStuff& planningStuff) {
+    const auto& schedulers = planningStuff.schedulers;
+    if (schedulers.size() != 1 || planningStuff.scheduler != schedulers.front()
+            || planningStuff.plannedOrder.size() != taskGraph.tasks.size()
+            || static_cast<int>(planningStuff.processors.size()) != CORES_COUNT) {
+        planning(taskGraph, compactTaskGraph, rootTasks, CORES_COUNT, planningStuff);
+        return;
+    }
+    planningWith(taskGraph, compactTaskGraph, rootTasks, CORES_COUNT, planningStuff, schedulers.front(), true);
+    planningStuff.makespanOf.assign(1, planningStuff.finishedAt());
+}
+
+void copyPlanning(const PlanningStuff& from, PlanningStuff& to) {
+    to.processors = from.processors;
+    to.assignmentOf = from.assignmentOf;
+    to.startOf = from.startOf;
+    to.arrivalOf = from.arrivalOf;
+    to.network = from.network;
+    to.scheduler = from.scheduler;
+    to.makespanOf = from.makespanOf;
+    to.plannedOrder = from.plannedOrder;
+    to.plannedWeightOf = from.plannedWeightOf;
+    to.plannedOptimisticOnClass = from.plannedOptimisticOnClass;
+    to.plannedPinnedCoreOf = from.plannedPinnedCoreOf;
+    to.workspace.priorityOf = from.workspace.priorityOf;
+}
+
+int plannedEnergy(const TaskGraph& taskGraph, const CompactTaskGraph& compactTaskGraph,
+        const PlanningStuff& planningStuff) {
+    int totalEnergy = 0;
+    for (int id = 0; id < compactTaskGraph.tasksCount; id++) {
+        const unsigned int core = planningStuff.assignmentOf[id].first;
+        const int energy = compactTaskGraph.energy(id, taskGraph.tasks[id].policy);
+        totalEnergy += planningStuff.processors[core].profile.energyOf(energy);
+    }
+    return totalEnergy;
+}
+
+// The Tasks that the Parents of taskId lead to, in depth first order, each once
+void collectSuggestions(int taskId, const CompactTaskGraph& compactTaskGraph, const PlanningStuff& planningStuff,
+        BlameWorkspace& workspace, std::vector<int>& suggestions) {
+    using Blame = BlameWorkspace::Blame;
+    auto& [blameOf, _visited, _stack, stampOf, stamp, collecting, _suggestions, _costOf] = workspace;
+    stamp++;
+    suggestions.clear();
+    collecting.assign(1, taskId);
+    while (!collecting.empty()) {
+        const int id = collecting.back();
+        collecting.pop_back();
+        if (stampOf[id] == stamp) continue;
+        stampOf[id] = stamp;
+        if (blameOf[id] == Blame::Self) {
+            suggestions.push_back(id);
+            continue;
+        }
+        if (blameOf[id] != Blame::Parents) continue;
+        const auto parents = compactTaskGraph.predecessorsOf(id);
+        for (auto edge = parents.end(); edge != parents.begin();) { // in reverse, so they come off in order
+            edge--;
+            if (planningStuff.arrivalOf[edge - compactTaskGraph.predecessors] == planningStuff.startOf[id]) {
+                collecting.push_back(edge->id);
+            }
+        }
+    }
+}
+
+const std::vector<int>& findEarliestToImproveFrom(int taskId, const TaskGraph& taskGraph,
+        const CompactTaskGraph& compactTaskGraph, const PlanningStuff& planningStuff, BlameWorkspace& workspace,
+        SpeedupMode mode) {
+    using Blame = BlameWorkspace::Blame;
+    auto& [blameOf, visited, stack, stampOf, _stamp, _collecting, suggestions, costOf] = workspace;
+    blameOf.resize(taskGraph.tasks.size(), Blame::Unknown);
+    stampOf.resize(taskGraph.tasks.size(), 0);
+    const bool cheapest = mode == SpeedupMode::Cheapest;
+    if (cheapest) costOf.resize(taskGraph.tasks.size());
+    const auto heldUp = [&planningStuff, &compactTaskGraph](int id, const CompactTaskGraph::Edge& edge){
+        return planningStuff.arrivalOf[&edge - compactTaskGraph.predecessors] == planningStuff.startOf[id];
+    };
+    const auto selfCost = [&taskGraph, &compactTaskGraph](int id){
+        return speedupCost(compactTaskGraph, id, taskGraph.tasks[id].policy);
+    };
+
+    // Depth first through the parents that held the Tasks up, each Task being
+    // blamed once all of those parents are, or as soon as one of them has
+    // nothing to suggest and the Task can improve
+    const auto visit = [&blameOf, &visited, &stack](int id){
+        blameOf[id] = Blame::Visiting;
+        visited.push_back(id);
+        stack.emplace_back(id, 0);
+    };
+    visit(taskId);
+    while (!stack.empty()) {
+        auto& [id, position] = stack.back();
+        const auto& task = taskGraph.tasks[id];
+        const auto parents = compactTaskGraph.predecessorsOf(id);
+        // The parent visited last is blamed by now
+        if (position > 0) {
+            const int parent = parents.begin()[position - 1].id;
+            if (blameOf[parent] == Blame::Nothing && task.canImprove()) {
+                blameOf[id] = Blame::Self;
+                if (cheapest) costOf[id] = selfCost(id);
+                stack.pop_back();
+                continue;
+            }
+        }
+        const int parentsCount = parents.end() - parents.begin();
+        while (position < parentsCount && !heldUp(id, parents.begin()[position])) position++;
+        if (position < parentsCount) {
+            const int parent = parents.begin()[position++].id;
+            if (blameOf[parent] == Blame::Unknown) visit(parent);
+            continue;
+        }
+
+        bool suggested = false;
+        double suggestionsCost = 0.0;
+        for (const auto& edge : parents) {
+            if (heldUp(id, edge) && blameOf[edge.id] != Blame::Nothing) {
+                suggested = true;
+                if (cheapest) suggestionsCost += costOf[edge.id];
+            }
+        }
+        if (suggested) {
+            blameOf[id] = Blame::Parents;
+            if (cheapest) {
+                costOf[id] = suggestionsCost;
+                if (task.canImprove() && selfCost(id) <= suggestionsCost) {
+                    blameOf[id] = Blame::Self;
+                    costOf[id] = selfCost(id);
+                }
+            }
+        } else {
+            blameOf[id] = task.canImprove() ? Blame::Self : Blame::Nothing;
+            if (cheapest) costOf[id] = task.canImprove() ? selfCost(id) : 0.0;
+        }
+        stack.pop_back();
+    }
+
+    collectSuggestions(taskId, compactTaskGraph, planningStuff, workspace, suggestions);
+    for (int id : visited) blameOf[id] = Blame::Unknown;
+    visited.clear();
+    return suggestions;
+}
+
+void improvePlanning(TaskGraph& taskGraph, const CompactTaskGraph& compactTaskGraph,
+        CriticalPathTracker& criticalPathTracker, const std::vector<int>& rootTaskIndices,
+        int desiredTime, int coresCount, PlanningStuff& planningStuff, SpeedupMode mode) {
+    Trace* const trace = planningStuff.trace;
+    for (int round = 0; true; round++) {
+        if (round == 0) planning(taskGraph, compactTaskGraph, rootTaskIndices, coresCount, planningStuff);
+        else replanning(taskGraph, compactTaskGraph, rootTaskIndices, coresCount, planningStuff);
+        const auto& assignmentOf = planningStuff.assignmentOf;
+        if (trace) {
+            trace->sample("improve_planning", round, planningStuff.finishedAt(), plannedEnergy(taskGraph, compactTaskGraph, planningStuff));
+        }
+
+        if (planningStuff.finishedAt() <= desiredTime) break;
+
+        // Else try to improve
+        // Find earliest of late finish time
+        // On a slow core a Task may start in time and still finish late
+        int earliestTime = -1;
+        unsigned int earliestId = taskGraph.tasks.size(); // none
+        for (unsigned int taskId = 0; taskId < taskGraph.tasks.size(); taskId++) {
+            const auto& task = taskGraph.tasks[taskId];
+            const auto startTime = planningStuff.startOf[taskId];
+            const int late = desiredTime + *task.late;
+            const int weight = compactTaskGraph.weight(taskId, task.policy);
+            if (startTime > late || assignmentOf[taskId].second > late + weight) { // started or finished late
+                if (earliestTime == -1 || earliestTime > startTime) {
+                    earliestTime = startTime;
+                    earliestId = taskId;
+                }
+            }
+        }
+        if (earliestId == taskGraph.tasks.size()) break; // none, though the total time is late
+
+        const auto& suggestedImprovements = findEarliestToImproveFrom(earliestId, taskGraph, compactTaskGraph,
+                planningStuff, planningStuff.blameWorkspace, mode);
+        if (suggestedImprovements.empty()) break; // nothing to be done
+
+        for (int s : suggestedImprovements) {
+            taskGraph.tasks[s].policy--; // improve performance of this Task
+            criticalPathTracker.taskChanged(s);
+        }
+        if (trace) trace->count(Trace::Counter::PolicyDecrements, suggestedImprovements.size());
+    }
+}
@@ -0,0 +1,230 @@
+#pragma once
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <utility>
+#include <optional>
+#include <string_view>
+#include "taskGraph.h"
+#include "criticalPath.h"
+#include "freeSlots.h"
+#include "network.h"
+#include "trace.h"
+
+
+struct TransferEvent {
+    int start, duration, src, dst;
+    inline TransferEvent(int start, int duration, int src, int dst) noexcept
+        : start(start), duration(duration), src(src), dst(dst) {}
+    int finish() const noexcept { return start + duration; }
+};
+
+struct ProcessingEvent {
+    int start, finish, taskId;
+    inline ProcessingEvent(int start, int finish, int taskId) noexcept
+        : start(start), finish(finish), taskId(taskId) {}
+    // int duration() const noexcept { return start + duration; }
+};
+
+
+// How a core compares to the nominal one the weights and energies of the
+// Tasks are given for, the same for every policy
+struct CoreProfile {
+    int speedPercent = 100; // a Task takes 100 / speedPercent of its weight
+    int energyPercent = 100; // and that much of its energy
+
+    // In long long, as weight * 100 and energy * energyPercent may not fit an
+    // int, and capped at the largest int
+    int weightOf(int weight) const noexcept {
+        return saturated((weight * 100LL + speedPercent - 1) / speedPercent);
+    }
+    int energyOf(int energy) const noexcept {
+        return saturated((static_cast<long long>(energy) * energyPercent + 50) / 100);
+    }
+    bool operator==(const CoreProfile& other) const noexcept {
+        return speedPercent == other.speedPercent && energyPercent == other.energyPercent;
+    }
+
+private:
+    static int saturated(long long value) noexcept {
+        return static_cast<int>(std::min<long long>(value, std::numeric_limits<int>::max()));
+    }
+};
+
+// speed:energy percents per core, each optionally xCount, e.g. 150:180x2,60:40x2
+std::optional<std::vector<CoreProfile>> parseCoreProfiles(std::string_view spec);
+
+
+// The order the Tasks are planned in and how each picks its core
+enum class Scheduler {
+    Delta, // the least delta() first, each on the core it finishes first on
+    Heft, // the highest upward rank (mean weight plus the longest mean path after it) first, the same cores (HEFT)
+    Peft // the highest mean optimistic cost first, each on its least finish plus optimistic cost (PEFT)
+};
+
+// "delta", "heft" or "peft"
+std::optional<Scheduler> parseScheduler(std::string_view name) noexcept;
+// A comma separated list of them, or "best" for all of them
+std::optional<std::vector<Scheduler>> parseSchedulers(std::string_view list);
+const char* nameOf(Scheduler scheduler) noexcept;
+
+
+struct Processor {
+    CoreProfile profile; // kept by clear()
+    std::vector<ProcessingEvent> processingTimeline;
+    std::vector<TransferEvent> transferTimeline;
+    FreeSlots freeSlots; // of the processingTimeline
+
+    int finishedAt() const noexcept {
+        return freeSlots.lastStart();
+    }
+
+    int availableAt(int duration, int let) const noexcept {
+        return freeSlots.earliestFit(duration, let);
+    }
+
+    void assign(int start, int finish, int taskId) {
+        processingTimeline.emplace_back(start, finish, taskId);
+        freeSlots.occupy(start, finish);
+    }
+
+    void clear() {
+        processingTimeline.clear();
+        transferTimeline.clear();
+        freeSlots.clear();
+    }
+};
+
+
+// The least priority goes first, then the Task that became ready first
+struct ReadyTask {
+    long long priority;
+    int readyOrder;
+    int id;
+    ReadyTask(long long priority, int readyOrder, int id) noexcept
+        : priority(priority), readyOrder(readyOrder), id(id) {}
+    bool operator>(const ReadyTask& other) const noexcept {
+        if (priority != other.priority) return priority > other.priority;
+        return readyOrder > other.readyOrder;
+    }
+};
+
+// The buffers of planning()
+struct PlanningWorkspace {
+    std::vector<int> parentsLeft;
+    std::vector<CoreProfile> classProfiles;
+    std::vector<int> classOf, classSize;
+    std::vector<int> weightOf, weightOnClass, optimisticOnClass;
+    std::vector<long long> priorityOf;
+    std::vector<int> topologicalOrder, left; // of the ranks
+    std::vector<ReadyTask> readyTasks; // a heap, the most urgent on top
+    std::vector<int> stepOf; // of the replayed Tasks
+    std::vector<int> coreFinishedAt, weightOnCore, optimisticOnCore, canFinishAt;
+    std::vector<int> route;
+    std::vector<std::pair<int, int>> candidates, transfers;
+    TransferCache transferCache; // grows to the links times the most parents of a Task
+};
+
+// The buffers of findEarliestToImproveFrom()
+struct BlameWorkspace {
+    enum class Blame : unsigned char {
+        Unknown, // not visited yet
+        Visiting,
+        Self, // the Task itself is suggested
+        Parents, // whatever the parents that held it up suggest
+        Nothing
+    };
+    std::vector<Blame> blameOf; // of every Task, Unknown outside of a call
+    std::vector<int> visited; // the Tasks to reset blameOf of
+    std::vector<std::pair<int, int>> stack; // <Task, position in its predecessors>
+    std::vector<unsigned int> stampOf; // when the Task was last collected
+    unsigned int stamp = 0;
+    std::vector<int> collecting;
+    std::vector<int> suggestions;
+    std::vector<double> costOf; // of what the Task suggests, with SpeedupMode::Cheapest
+};
+
+struct PlanningStuff {
+    std::vector<Processor> processors;
+    // <core, finish time>
+    std::vector<std::pair<unsigned int, int>> assignmentOf;
+    // The weight of a Task depends on its core, so the start time is kept too
+    std::vector<int> startOf;
+    // When the data of every transfer is on the core of its Target, in the
+    // order of CompactTaskGraph::predecessors
+    std::vector<int> arrivalOf;
+    Network network; // the model is kept from one planning to the next
+    std::vector<Scheduler> schedulers{ Scheduler::Delta }; // planning() keeps the best of theirs
+    Scheduler scheduler = Scheduler::Delta; // that the planning was made by
+    std::vector<int> makespanOf; // by every one of the schedulers, in their order
+    // What the planning was made from, for replanning() to tell where it changes
+    std::vector<int> plannedOrder;
+    std::vector<int> plannedWeightOf;
+    std::vector<int> plannedOptimisticOnClass;
+    std::vector<int> plannedPinnedCoreOf;
+    // Of searchPlanning(), empty otherwise: the core of every Task (-1 for any)
+    // and a bias to its priority
+    std::vector<int> pinnedCoreOf;
+    std::vector<long long> priorityBiasOf;
+    PlanningWorkspace workspace;
+    BlameWorkspace blameWorkspace; // of improvePlanning()
+    Trace* trace = nullptr; // of the planning passes and the improvePlanning() rounds, if any
+
+    PlanningStuff() noexcept {}
+    PlanningStuff(std::vector<Processor>&& processors, std::vector<std::pair<unsigned int, int>>&& assignmentOf)
+        : processors(std::move(processors)), assignmentOf(std::move(assignmentOf)) {}
+
+    // The makespan
+    int finishedAt() const noexcept {
+        int totalTime = 0;
+        for (const auto& processor : processors) {
+            const int finish = processor.finishedAt();
+            if (finish > totalTime) totalTime = finish;
+        }
+        return totalTime;
+    }
+
+    // The first profiles to the first cores, the rest nominal
+    void setCoreProfiles(const std::vector<CoreProfile>& profiles, int coresCount) {
+        processors.resize(coresCount);
+        for (int core = 0; core < coresCount; core++) {
+            processors[core].profile = core < static_cast<int>(profiles.size()) ? profiles[core] : CoreProfile();
+        }
+    }
+};
+
+PlanningStuff planning(const TaskGraph& taskGraph, const CompactTaskGraph& compactTaskGraph,
+        const std::vector<int>& rootTasks, int CORES_COUNT);
+// Into the PlanningStuff, by the best of its schedulers, the first on a tie
+void planning(const TaskGraph& taskGraph, const CompactTaskGraph& compactTaskGraph,
+        const std::vector<int>& rootTasks, int CORES_COUNT, PlanningStuff& planningStuff);
+// By the one scheduler
+void planning(const TaskGraph& taskGraph, const CompactTaskGraph& compactTaskGraph,
+        const std::vector<int>& rootTasks, int CORES_COUNT, PlanningStuff& planningStuff, Scheduler scheduler);
+
+// The same as planning() anew, after only some policies changed since the last
+// planning into planningStuff. With one scheduler it replays from the first Task that changes
+void replanning(const TaskGraph& taskGraph, const CompactTaskGraph& compactTaskGraph,
+        const std::vector<int>& rootTasks, int CORES_COUNT, PlanningStuff& planningStuff);
+
+// The planning and what replanning() needs of it, without the workspace
+void copyPlanning(const PlanningStuff& from, PlanningStuff& to);
+
+// The energy of the Tasks on the profiles of the cores they are planned on
+int plannedEnergy(const TaskGraph& taskGraph, const CompactTaskGraph& compactTaskGraph,
+        const PlanningStuff& planningStuff);
+
+// The earliest improvable Tasks on the chains of parents that held up the Task,
+// or with SpeedupMode::Cheapest the Task itself where it costs no more. In the workspace.
+const std::vector<int>& findEarliestToImproveFrom(int taskId, const TaskGraph& taskGraph,
+        const CompactTaskGraph& compactTaskGraph, const PlanningStuff& planningStuff, BlameWorkspace& workspace,
+        SpeedupMode mode = SpeedupMode::FirstOnPath);
+
+// Plans on coresCount cores and, while the planning misses the desired time,
+// speeds up the Tasks that held up the earliest late one, then replans.
+// The Tasks stay on the policies of the last planning, which is left in planningStuff.
+void improvePlanning(TaskGraph& taskGraph, const CompactTaskGraph& compactTaskGraph,
+        CriticalPathTracker& criticalPathTracker, const std::vector<int>& rootTaskIndices,
+        int desiredTime, int coresCount, PlanningStuff& planningStuff,
+        SpeedupMode mode = SpeedupMode::FirstOnPath);
@@ -0,0 +1,138 @@
+#include "solver.h"
+
+#include "json.h"
+
+
+// The Tasks only hold the policies, Early and Late, the rest is read from the CompactTaskGraph
+Solution solve(TaskGraph& taskGraph, const CompactTaskGraph& compactTaskGraph, int desiredTime, int coresCount,
+        SolverWorkspace& workspace, std::ostream& log, const SolverOptions& options, Trace* trace) {
+    const auto start = std::chrono::steady_clock::now();
+    const ScopedTimer timer(trace, "solve");
+    auto& [rootTaskIndices, topologicalOrder, inDegree, speedupWorkspace, planningStuff, speedupPolicies,
+        _compactTaskGraph, _blankTaskGraph] = workspace;
+    planningStuff.trace = trace;
+    planningStuff.pinnedCoreOf.clear();
+    planningStuff.priorityBiasOf.clear();
+    Solution solution;
+    getRootTasks(compactTaskGraph, rootTaskIndices);
+    getTopologicalOrder(compactTaskGraph, topologicalOrder, inDegree);
+    if (static_cast<int>(topologicalOrder.size()) != static_cast<int>(taskGraph.tasks.size())) {
+        solution.acyclic = false;
+        return solution;
+    }
+    if (taskGraph.tasks.empty()) {
+        planningStuff.processors.assign(coresCount, Processor());
+        planningStuff.assignmentOf.clear();
+        planningStuff.startOf.clear();
+        planningStuff.makespanOf.clear();
+        solution.criticalPathMet = solution.planningMet = desiredTime >= 0;
+        return solution;
+    }
+
+    planningStuff.network.model = options.network;
+    planningStuff.setCoreProfiles(options.coreProfiles, coresCount);
+    planningStuff.schedulers = options.schedulers;
+    for (auto& task : taskGraph.tasks) task.policy = compactTaskGraph.policiesCount - 1;
+    CriticalPathTracker criticalPathTracker(taskGraph, compactTaskGraph, rootTaskIndices, topologicalOrder);
+    criticalPathTracker.trace = trace;
+    {
+        const ScopedTimer stageTimer(trace, "speedup");
+        solution.criticalPathMet = speedupCriticalPath(taskGraph, criticalPathTracker, desiredTime,
+                options.speedupMode, speedupWorkspace);
+    }
+    for (int id = 0; id < compactTaskGraph.tasksCount; id++) {
+        solution.speedupEnergy += compactTaskGraph.energy(id, taskGraph.tasks[id].policy);
+    }
+    if (solution.criticalPathMet && options.energyBudget) {
+        speedupPolicies.clear();
+        for (const auto& task : taskGraph.tasks) speedupPolicies.push_back(task.policy);
+        const ScopedTimer stageTimer(trace, "minimize_energy");
+        solution.energyOptimization = minimizeEnergy(taskGraph, criticalPathTracker, desiredTime,
+                *options.energyBudget);
+        printEnergyComparison(taskGraph, compactTaskGraph, speedupPolicies, *solution.energyOptimization, log);
+    }
+    if (solution.criticalPathMet) {
+        const ScopedTimer stageTimer(trace, "improve_planning");
+        improvePlanning(taskGraph, compactTaskGraph, criticalPathTracker,
+                rootTaskIndices, desiredTime, coresCount, planningStuff, options.speedupMode);
+    } else {
+        planning(taskGraph, compactTaskGraph, rootTaskIndices, coresCount, planningStuff);
+    }
+    if (options.anytimeBudget) {
+        const ScopedTimer stageTimer(trace, "anytime");
+        solution.anytimeSearch = searchPlanning(taskGraph, criticalPathTracker, rootTaskIndices, desiredTime,
+                coresCount, planningStuff, *options.anytimeBudget, start);
+    }
+
+    solution.makespan = planningStuff.finishedAt();
+    solution.planningMet = solution.makespan <= desiredTime;
+    solution.energy = plannedEnergy(taskGraph, compactTaskGraph, planningStuff);
+    return solution;
+}
+
+Solution solve(TaskGraph& taskGraph, int desiredTime, int coresCount, SolverWorkspace& workspace, std::ostream& log,
+        const SolverOptions& options, Trace* trace) {
+    workspace.compactTaskGraph.assign(taskGraph);
+    return solve(taskGraph, workspace.compactTaskGraph, desiredTime, coresCount, workspace, log, options, trace);
+}
+
+Solution solve(const CompactTaskGraph& compactTaskGraph, int desiredTime, int coresCount, SolverWorkspace& workspace,
+        std::ostream& log, const SolverOptions& options, Trace* trace) {
+    makeBlankTaskGraph(compactTaskGraph, workspace.blankTaskGraph);
+    return solve(workspace.blankTaskGraph, compactTaskGraph, desiredTime, coresCount, workspace, log, options, trace);
+}
+
+void writeSolutionJson(std::ostream& os, std::string_view instance, int coresCount, int desiredTime,
+        const TaskGraph& taskGraph, const PlanningStuff& planningStuff, const Solution& solution) {
+    os << "{\"instance\": ";
+    writeJsonString(os, instance);
+    os << ", \"cores\": " << coresCount << ", \"tasks\": " << taskGraph.tasks.size()
+        << ", \"desired_time\": " << desiredTime << ", \"status\": ";
+    if (!solution.acyclic) {
+        os << "\"cyclic\"}\n";
+        return;
+    }
+    if (!solution.criticalPathMet) os << "\"infeasible\"";
+    else if (!solution.planningMet) os << "\"missed\"";
+    else os << "\"met\"";
+    os << ", \"makespan\": " << solution.makespan << ", \"energy\": " << solution.energy;
+    if (const auto& optimization = solution.energyOptimization) {
+        os << ", \"speedup_energy\": " << solution.speedupEnergy
+            << ", \"optimized_energy\": " << optimization->energy
+            << ", \"lower_bound\": " << optimization->lowerBound << ", \"gap\": " << optimization->gap()
+            << ", \"iterations\": " << optimization->iterations;
+    }
+    if (const auto& search = solution.anytimeSearch) {
+        os << ", \"greedy_makespan\": " << search->startMakespan << ", \"greedy_energy\": " << search->startEnergy
+            << ", \"moves\": " << search->moves << ", \"improvements\": " << search->improvements
+            << ", \"cancelled\": " << (search->cancelled ? "true" : "false");
+    }
+
+    const auto& schedulers = planningStuff.schedulers;
+    if (!planningStuff.makespanOf.empty() && (schedulers.size() > 1 || schedulers[0] != Scheduler::Delta)) {
+        os << ", \"scheduler\": \"" << nameOf(planningStuff.scheduler) << "\", \"makespans\": {";
+        for (unsigned int i = 0; i < schedulers.size(); i++) {
+            os << (i ? ", " : "") << '"' << nameOf(schedulers[i]) << "\": " << planningStuff.makespanOf[i];
+        }
+        os << '}';
+    }
+
+    os << ", \"policies\": [";
+    for (unsigned int id = 0; id < taskGraph.tasks.size(); id++) {
+        os << (id ? ", " : "") << taskGraph.tasks[id].policy;
+    }
+    os << "], \"schedule\": [";
+    for (unsigned int id = 0; id < planningStuff.assignmentOf.size(); id++) {
+        const auto [core, finish] = planningStuff.assignmentOf[id];
+        os << (id ? ", " : "") << '[' << core << ", " << planningStuff.startOf[id] << ", " << finish << ']';
+    }
+    os << "]}\n";
+}
+
+void writeErrorJson(std::ostream& os, std::string_view instance, std::string_view message) {
+    os << "{\"instance\": ";
+    writeJsonString(os, instance);
+    os << ", \"error\": ";
+    writeJsonString(os, message);
+    os << "}\n";
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <string_view>
+#include <optional>
+#include "taskGraph.h"
+#include "criticalPath.h"
+#include "planning.h"
+#include "energyOptimizer.h"
+#include "anytime.h"
+#include "trace.h"
+
+
+// The buffers of the whole pipeline
+struct SolverWorkspace {
+    std::vector<int> rootTaskIndices;
+    std::vector<int> topologicalOrder;
+    std::vector<int> inDegree;
+    SpeedupWorkspace speedupWorkspace;
+    PlanningStuff planningStuff;
+    std::vector<int> speedupPolicies; // to compare minimizeEnergy() with
+    CompactTaskGraph compactTaskGraph; // of the TaskGraph solved
+    TaskGraph blankTaskGraph{ true }; // of the CompactTaskGraph solved
+};
+
+struct SolverOptions {
+    SpeedupMode speedupMode = SpeedupMode::FirstOnPath;
+    std::optional<EnergyBudget> energyBudget; // to minimizeEnergy() after the speedup
+    NetworkModel network; // for the planning
+    std::vector<CoreProfile> coreProfiles; // of the first cores, the rest nominal
+    std::vector<Scheduler> schedulers{ Scheduler::Delta }; // the planning is the best of theirs
+    // To searchPlanning() after improvePlanning(), the budget running from the start of solve()
+    std::optional<AnytimeBudget> anytimeBudget;
+};
+
+struct Solution {
+    bool acyclic = true;
+    bool criticalPathMet = false; // even the critical path may not meet the desired time
+    bool planningMet = false;
+    int makespan = 0;
+    int energy = 0; // on the profiles of the cores planned on
+    int speedupEnergy = 0; // right after the speedup, before any minimizeEnergy() and improvePlanning()
+    std::optional<EnergyOptimization> energyOptimization;
+    std::optional<AnytimeSearch> anytimeSearch;
+};
+
+// The pipeline of main without the drawing: the speedup, minimizeEnergy() with an
+// energy budget, improvePlanning(), then searchPlanning() with an anytime budget.
+// Leaves the policies in the Tasks and the planning in the workspace. Prints
+// only the energy comparison, on log.
+Solution solve(TaskGraph& taskGraph, int desiredTime, int coresCount, SolverWorkspace& workspace, std::ostream& log,
+        const SolverOptions& options = SolverOptions(), Trace* trace = nullptr);
+// The same on the graph as it is, e.g. mapped by loadBinaryTaskGraph(). The
+// policies are left in workspace.blankTaskGraph
+Solution solve(const CompactTaskGraph& compactTaskGraph, int desiredTime, int coresCount, SolverWorkspace& workspace,
+        std::ostream& log, const SolverOptions& options = SolverOptions(), Trace* trace = nullptr);
+
+// One line of JSON: the outcome, the policy of every Task and its <core, start, finish>.
+// With other schedulers than the default also the one chosen and the makespan of each,
+// and with an anytime search the greedy makespan and energy it started from
+void writeSolutionJson(std::ostream& os, std::string_view instance, int coresCount, int desiredTime,
+        const TaskGraph& taskGraph, const PlanningStuff& planningStuff, const Solution& solution);
+
+void writeErrorJson(std::ostream& os, std::string_view instance, std::string_view message);
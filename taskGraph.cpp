@@ -0,0 +1,140 @@
+#include "taskGraph.h"
+
+
+void makeBlankTaskGraph(const CompactTaskGraph& compactTaskGraph, TaskGraph& taskGraph) {
+    taskGraph.indexingFromZero = compactTaskGraph.indexingFromZero;
+    taskGraph.policiesCount = compactTaskGraph.policiesCount;
+    taskGraph.transfers.clear();
+    taskGraph.tasks.clear();
+    taskGraph.tasks.resize(compactTaskGraph.tasksCount, Task({}, {}));
+}
+
+std::vector<int> getRootTasks(const TaskGraph& taskGraph) {
+    std::vector<int> rootTaskIndices;
+    getRootTasks(taskGraph, rootTaskIndices);
+    return rootTaskIndices;
+}
+
+void getRootTasks(const TaskGraph& taskGraph, std::vector<int>& rootTaskIndices) {
+    rootTaskIndices.clear();
+    for (unsigned int i = 0; i < taskGraph.tasks.size(); i++) {
+        if (taskGraph.tasks[i].parents.empty()) rootTaskIndices.push_back(i);
+    }
+}
+
+void getRootTasks(const CompactTaskGraph& compactTaskGraph, std::vector<int>& rootTaskIndices) {
+    rootTaskIndices.clear();
+    for (int id = 0; id < compactTaskGraph.tasksCount; id++) {
+        if (compactTaskGraph.predecessorsOf(id).empty()) rootTaskIndices.push_back(id);
+    }
+}
+
+std::vector<int> getTopologicalOrder(const TaskGraph& taskGraph) {
+    std::vector<int> order;
+    std::vector<int> inDegree;
+    getTopologicalOrder(taskGraph, order, inDegree);
+    return order;
+}
+
+void getTopologicalOrder(const TaskGraph& taskGraph, std::vector<int>& order, std::vector<int>& inDegree) {
+    const int tasksCount = taskGraph.tasks.size();
+    inDegree.assign(tasksCount, 0);
+    for (const auto& task : taskGraph.tasks) {
+        for (const auto& [dst, _volume] : task.targets) inDegree[dst]++;
+    }
+
+    order.clear();
+    order.reserve(tasksCount);
+    for (int id = 0; id < tasksCount; id++) {
+        if (inDegree[id] == 0) order.push_back(id);
+    }
+    // The order itself serves as the queue
+    for (unsigned int head = 0; head < order.size(); head++) {
+        for (const auto& [dst, _volume] : taskGraph.tasks[order[head]].targets) {
+            if (--inDegree[dst] == 0) order.push_back(dst);
+        }
+    }
+}
+
+std::vector<int> getTopologicalOrder(const CompactTaskGraph& compactTaskGraph) {
+    std::vector<int> order;
+    std::vector<int> inDegree;
+    getTopologicalOrder(compactTaskGraph, order, inDegree);
+    return order;
+}
+
+void getTopologicalOrder(const CompactTaskGraph& compactTaskGraph, std::vector<int>& order, std::vector<int>& inDegree) {
+    const int tasksCount = compactTaskGraph.tasksCount;
+    inDegree.resize(tasksCount);
+    for (int id = 0; id < tasksCount; id++) inDegree[id] = compactTaskGraph.predecessorsOf(id).size();
+
+    order.clear();
+    order.reserve(tasksCount);
+    for (int id = 0; id < tasksCount; id++) {
+        if (inDegree[id] == 0) order.push_back(id);
+    }
+    for (unsigned int head = 0; head < order.size(); head++) {
+        for (const auto& [dst, _volume] : compactTaskGraph.successorsOf(order[head])) {
+            if (--inDegree[dst] == 0) order.push_back(dst);
+        }
+    }
+}
+
+std::optional<std::vector<int>> findCycle(const TaskGraph& taskGraph, const std::vector<int>& topologicalOrder) {
+    const int tasksCount = taskGraph.tasks.size();
+    if (static_cast<int>(topologicalOrder.size()) == tasksCount) return std::nullopt;
+
+    std::vector<int> stepOf(tasksCount, -1); // -1 for missing, -2 for ordered
+    for (int id : topologicalOrder) stepOf[id] = -2;
+    int currId = 0;
+    while (stepOf[currId] == -2) currId++;
+
+    std::vector<int> walk;
+    while (stepOf[currId] == -1) {
+        stepOf[currId] = walk.size();
+        walk.push_back(currId);
+        for (int parent : taskGraph.tasks[currId].parents) {
+            if (stepOf[parent] != -2) {
+                currId = parent;
+                break;
+            }
+        }
+    }
+
+    std::vector<int> cycle(walk.begin() + stepOf[currId], walk.end());
+    std::reverse(cycle.begin(), cycle.end());
+    return { cycle };
+}
+
+void printResult(const TaskGraph& taskGraph, const CompactTaskGraph& compactTaskGraph, std::ostream& os) {
+    int id = 0;
+    for (const auto& task : taskGraph.tasks) {
+        os << "Task {" << id++ << "} is on V(" << task.policy << ")" << '\n';
+    }
+
+    int totalEnergy = 0;
+    for (id = 0; id < compactTaskGraph.tasksCount; id++) {
+        totalEnergy += compactTaskGraph.energy(id, taskGraph.tasks[id].policy);
+    }
+    os << "Total energy consumption = " << totalEnergy << '\n';
+}
+
+std::ostream& operator<<(std::ostream& os, const TaskGraph& taskGraph) {
+    os << "------ TASK GRAPH begin ------\n";
+    int id = 0;
+    for (const auto& task : taskGraph.tasks) {
+        os << "Task {" << id++ << "} Weights = ";
+        for (int w : task.weights) os << w << ',';
+        os << " Energies = ";
+        for (int e : task.energies) os << e << ',';
+        os << " Parents = ";
+        for (int p : task.parents) os << '{' << p << '}' << ',';
+        os << " Targets = ";
+        for (const auto& [dst, volume] : task.targets) {
+            os << "{" << dst << "}_" << volume << ", ";
+        }
+        os << '\n';
+    }
+    os << "------ TASK GRAPH end ------\n";
+    return os;
+}
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <optional>
+
+
+struct Transfer {
+    int src, dst, volume;
+    Transfer(int src, int dst, int volume) noexcept : src(src), dst(dst), volume(volume) {}
+};
+
+struct TransferTo {
+    int dst, volume;
+    TransferTo(int dst, int volume) noexcept : dst(dst), volume(volume) {}
+};
+
+struct Task {
+    std::vector<int> weights;
+    std::vector<int> energies;
+    std::vector<TransferTo> targets;
+    std::vector<int> parents;
+
+    int policy = 0;
+    std::optional<int> early = std::nullopt;
+    std::optional<int> late = std::nullopt;
+
+    bool canImprove() const noexcept { return policy > 0; }
+    int delta() const noexcept { return *late - *early; }
+    int weight() const noexcept { return weights[policy]; }
+    int energy() const noexcept { return energies[policy]; }
+    void clearStats() noexcept { early = std::nullopt; late = std::nullopt; }
+    int volumeOfTargetTo(int id) const noexcept {
+        for (const auto& [dst, volume] : targets) {
+            if (dst == id) return volume;
+        }
+        return -1;
+    }
+
+    Task(std::vector<int>&& weights, std::vector<int>&& energies) noexcept
+        : weights(std::move(weights)), energies(std::move(energies)) {}
+};
+
+struct TaskGraph {
+    std::vector<Task> tasks;
+    std::vector<Transfer> transfers; // redundant. for convenience
+    bool indexingFromZero; // to determine what output the User expects
+    int policiesCount = 0; // of every Task, kept for a graph without Tasks too
+
+    TaskGraph(bool indexingFromZero) noexcept : indexingFromZero(indexingFromZero) {}
+    void add(std::vector<int>&& weights, std::vector<int>&& energies) noexcept {
+        policiesCount = weights.size();
+        tasks.emplace_back(std::move(weights), std::move(energies));
+    }
+    void addTransfer(int src, int dst, int volume) noexcept {
+        transfers.emplace_back(src, dst, volume);
+        tasks[src].targets.emplace_back(dst, volume);
+        tasks[dst].parents.emplace_back(src);
+    }
+    void removeLastTransfer(int src, int dst) noexcept {
+        transfers.erase(transfers.end());
+        tasks[src].targets.erase(tasks[src].targets.end());
+        tasks[dst].parents.erase(tasks[dst].parents.end());
+    }
+};
+
+// The frozen form of a TaskGraph for the hot loops: CSR links and [task][policy] matrices.
+// The policy, Early and Late stay in TaskGraph::tasks.
+struct CompactTaskGraph {
+    struct Edge {
+        int id, volume;
+    };
+    struct EdgeRange {
+        const Edge* first;
+        const Edge* last;
+        const Edge* begin() const noexcept { return first; }
+        const Edge* end() const noexcept { return last; }
+        int size() const noexcept { return last - first; }
+        bool empty() const noexcept { return first == last; }
+    };
+
+    int tasksCount = 0;
+    int policiesCount = 0;
+    bool indexingFromZero = true;
+    // Views into the storage below
+    const int* weights = nullptr; // [task * policiesCount + policy]
+    const int* energies = nullptr; // [task * policiesCount + policy]
+    const int* successorOffsets = nullptr; // [tasksCount + 1]
+    const Edge* successors = nullptr; // Targets, in the TaskGraph order
+    const int* predecessorOffsets = nullptr; // [tasksCount + 1]
+    const Edge* predecessors = nullptr; // parents, by id
+
+    // Nothing to view until assign()
+    CompactTaskGraph() = default;
+    explicit CompactTaskGraph(const TaskGraph& taskGraph) {
+        assign(taskGraph);
+    }
+    // Views into memory kept alive by the owner, e.g. a mapped file. The arrays
+    // follow each other in the order of the members above.
+    CompactTaskGraph(int tasksCount, int policiesCount, bool indexingFromZero,
+            const int* data, std::shared_ptr<const void> owner) noexcept
+            : tasksCount(tasksCount), policiesCount(policiesCount), indexingFromZero(indexingFromZero),
+              owner(std::move(owner)) {
+        const std::size_t matrixSize = static_cast<std::size_t>(tasksCount) * policiesCount;
+        weights = data;
+        energies = weights + matrixSize;
+        successorOffsets = energies + matrixSize;
+        predecessorOffsets = successorOffsets + tasksCount + 1;
+        const int edgesCount = successorOffsets[tasksCount];
+        successors = reinterpret_cast<const Edge*>(predecessorOffsets + tasksCount + 1);
+        predecessors = successors + edgesCount;
+    }
+    // The views point into the storage, which a move keeps but a copy does not
+    CompactTaskGraph(const CompactTaskGraph&) = delete;
+    CompactTaskGraph& operator=(const CompactTaskGraph&) = delete;
+    CompactTaskGraph(CompactTaskGraph&&) noexcept = default;
+    CompactTaskGraph& operator=(CompactTaskGraph&&) noexcept = default;
+
+    // Of the TaskGraph, into the storage it already has
+    void assign(const TaskGraph& taskGraph) {
+        tasksCount = taskGraph.tasks.size();
+        policiesCount = taskGraph.policiesCount;
+        indexingFromZero = taskGraph.indexingFromZero;
+        owner.reset();
+        const std::size_t matrixSize = static_cast<std::size_t>(tasksCount) * policiesCount;
+        const int edgesCount = taskGraph.transfers.size();
+        matrixStorage.resize(2 * matrixSize);
+        offsetStorage.assign(2 * (tasksCount + 1), 0);
+        edgeStorage.resize(2 * edgesCount);
+        int* weightsOut = matrixStorage.data();
+        int* energiesOut = weightsOut + matrixSize;
+        int* successorOffsetsOut = offsetStorage.data();
+        int* predecessorOffsetsOut = successorOffsetsOut + tasksCount + 1;
+        Edge* successorsOut = edgeStorage.data();
+        Edge* predecessorsOut = successorsOut + edgesCount;
+
+        for (int id = 0; id < tasksCount; id++) {
+            const auto& task = taskGraph.tasks[id];
+            std::copy(task.weights.begin(), task.weights.end(), weightsOut + id * policiesCount);
+            std::copy(task.energies.begin(), task.energies.end(), energiesOut + id * policiesCount);
+            successorOffsetsOut[id + 1] = successorOffsetsOut[id] + task.targets.size();
+            predecessorOffsetsOut[id + 1] = predecessorOffsetsOut[id] + task.parents.size();
+        }
+        // Both from the Targets in one pass. The offset of the next Task is the
+        // write cursor of the parents of a Task, and is shifted back after.
+        for (int id = 0; id < tasksCount; id++) {
+            Edge* successor = successorsOut + successorOffsetsOut[id];
+            for (const auto& [dst, volume] : taskGraph.tasks[id].targets) {
+                *successor++ = { dst, volume };
+                predecessorsOut[predecessorOffsetsOut[dst]++] = { id, volume };
+            }
+        }
+        for (int id = tasksCount; id > 0; id--) predecessorOffsetsOut[id] = predecessorOffsetsOut[id - 1];
+        predecessorOffsetsOut[0] = 0;
+
+        weights = weightsOut;
+        energies = energiesOut;
+        successorOffsets = successorOffsetsOut;
+        predecessorOffsets = predecessorOffsetsOut;
+        successors = successorsOut;
+        predecessors = predecessorsOut;
+    }
+
+    int edgesCount() const noexcept { return successorOffsets[tasksCount]; }
+    int weight(int id, int policy) const noexcept { return weights[id * policiesCount + policy]; }
+    int energy(int id, int policy) const noexcept { return energies[id * policiesCount + policy]; }
+    EdgeRange successorsOf(int id) const noexcept {
+        return { successors + successorOffsets[id], successors + successorOffsets[id + 1] };
+    }
+    EdgeRange predecessorsOf(int id) const noexcept {
+        return { predecessors + predecessorOffsets[id], predecessors + predecessorOffsets[id + 1] };
+    }
+
+private:
+    std::vector<int> matrixStorage; // weights, then energies
+    std::vector<int> offsetStorage; // successors, then predecessors
+    std::vector<Edge> edgeStorage; // successors, then predecessors
+    std::shared_ptr<const void> owner; // of the viewed memory, if not the storage
+};
+
+
+// Tasks without weights, energies or links, for the policies, Early and Late
+// of a graph that only the CompactTaskGraph holds, e.g. a mapped one.
+// Into the TaskGraph, keeping its storage
+void makeBlankTaskGraph(const CompactTaskGraph& compactTaskGraph, TaskGraph& taskGraph);
+
+std::vector<int> getRootTasks(const TaskGraph& taskGraph);
+// Into the vector, keeping its storage
+void getRootTasks(const TaskGraph& taskGraph, std::vector<int>& rootTaskIndices);
+void getRootTasks(const CompactTaskGraph& compactTaskGraph, std::vector<int>& rootTaskIndices);
+
+// Kahn's algorithm: the roots by id, then the Tasks as they become ready.
+// Incomplete if the graph has cycles.
+std::vector<int> getTopologicalOrder(const TaskGraph& taskGraph);
+// inDegree is scratch space
+void getTopologicalOrder(const TaskGraph& taskGraph, std::vector<int>& order, std::vector<int>& inDegree);
+// The same order, as the successors keep the order of the Targets
+std::vector<int> getTopologicalOrder(const CompactTaskGraph& compactTaskGraph);
+void getTopologicalOrder(const CompactTaskGraph& compactTaskGraph, std::vector<int>& order, std::vector<int>& inDegree);
+
+// A cycle through the Tasks missing from the topological order, in the direction of the transfers
+std::optional<std::vector<int>> findCycle(const TaskGraph& taskGraph, const std::vector<int>& topologicalOrder);
+
+void printResult(const TaskGraph& taskGraph, const CompactTaskGraph& compactTaskGraph, std::ostream& os = std::cout);
+
+std::ostream& operator<<(std::ostream& os, const TaskGraph& taskGraph);
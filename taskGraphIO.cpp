@@ -0,0 +1,461 @@
+#include "taskGraphIO.h"
+
+#include <fstream>
+#include <limits>
+#include <cstdint>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+MappedFile::MappedFile(std::string_view path) {
+    const int fd = open(std::string(path).c_str(), O_RDONLY);
+    if (fd == -1) return;
+    struct stat info;
+    if (fstat(fd, &info) == 0) {
+        opened = true;
+        size = info.st_size;
+        if (size > 0) {
+            void* address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (address == MAP_FAILED) {
+                opened = false;
+                size = 0;
+            } else {
+                data = static_cast<const char*>(address);
+                madvise(address, size, MADV_SEQUENTIAL);
+            }
+        }
+    }
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (data) munmap(const_cast<char*>(data), size);
+}
+
+std::ostream& operator<<(std::ostream& os, const ParseError& error) {
+    if (error.line > 0) os << error.line << ':' << error.column << ": ";
+    os << error.message;
+    return os;
+}
+
+// Tokens of the V/I/T/S format, separated by any whitespace
+struct TaskGraphScanner {
+    const char* curr;
+    const char* const end;
+    int line = 1;
+    const char* lineBegin;
+    const char* tokenBegin; // for the errors
+
+    TaskGraphScanner(const char* begin, const char* end) noexcept
+        : curr(begin), end(end), lineBegin(begin), tokenBegin(begin) {}
+
+    // Skips whitespace, returns false at the end of input
+    bool next() noexcept {
+        while (curr != end && (*curr == ' ' || *curr == '\t' || *curr == '\n' || *curr == '\r')) {
+            if (*curr == '\n') {
+                line++;
+                lineBegin = curr + 1;
+            }
+            curr++;
+        }
+        tokenBegin = curr;
+        return curr != end;
+    }
+
+    ParseError error(std::string&& message) const {
+        return { line, static_cast<int>(tokenBegin - lineBegin) + 1, std::move(message) };
+    }
+
+    std::optional<char> readChar() noexcept {
+        if (!next()) return std::nullopt;
+        return { *curr++ };
+    }
+
+    bool expectChar(char expected) noexcept {
+        if (!next() || *curr != expected) return false;
+        curr++;
+        return true;
+    }
+
+    std::optional<int> readInt() noexcept {
+        if (!next()) return std::nullopt;
+        const bool negative = *curr == '-';
+        const char* digits = negative ? curr + 1 : curr;
+        long long value = 0;
+        const char* p = digits;
+        while (p != end && '0' <= *p && *p <= '9') {
+            value = value * 10 + (*p - '0');
+            if (value > std::numeric_limits<int>::max()) return std::nullopt;
+            p++;
+        }
+        if (p == digits) return std::nullopt;
+        curr = p;
+        return { static_cast<int>(negative ? -value : value) };
+    }
+};
+
+std::optional<TaskGraph> parseTaskGraph(const char* begin, const char* end, ParseError& error) {
+    TaskGraphScanner scanner(begin, end);
+    const auto fail = [&error, &scanner](std::string&& message){
+        error = scanner.error(std::move(message));
+        return std::nullopt;
+    };
+
+    if (!scanner.expectChar('V')) return fail("Expected voltage levels amount (V) to be the first entry.");
+    const auto voltageLevelsAmount = scanner.readInt();
+    if (!voltageLevelsAmount || *voltageLevelsAmount <= 0) return fail("Expected a positive voltage levels amount.");
+
+    if (!scanner.expectChar('I')) return fail("Expected indexing specification to be the second entry.");
+    const auto indexing = scanner.readChar();
+    bool indexingFromZero;
+    if (indexing == '0') indexingFromZero = true;
+    else if (indexing == '1') indexingFromZero = false;
+    else return fail("Unexpected indexing specification.");
+
+    TaskGraph taskGraph(indexingFromZero);
+    taskGraph.policiesCount = *voltageLevelsAmount;
+    taskGraph.tasks.reserve(std::count(scanner.curr, end, 'T'));
+    taskGraph.transfers.reserve(std::count(scanner.curr, end, 'S'));
+    const int firstId = indexingFromZero ? 0 : 1;
+    int expectedId = firstId;
+    while (scanner.next()) {
+        const char type = *scanner.curr;
+        if (type == 'T') {
+            scanner.curr++;
+            const auto id = scanner.readInt();
+            if (!id) return fail("Expected a Task id.");
+            if (*id != expectedId) return fail("Unexpected indexing while listing Tasks.");
+            expectedId++;
+            std::vector<int> weights(*voltageLevelsAmount);
+            std::vector<int> energies(*voltageLevelsAmount);
+            if (!scanner.expectChar('W')) return fail("Expected weights (W).");
+            for (int& weight : weights) {
+                const auto value = scanner.readInt();
+                if (!value) return fail("Expected a weight.");
+                if (*value < 0) return fail("Negative weight.");
+                weight = *value;
+            }
+            if (!scanner.expectChar('E')) return fail("Expected energies (E).");
+            for (int& energy : energies) {
+                const auto value = scanner.readInt();
+                if (!value) return fail("Expected an energy.");
+                if (*value < 0) return fail("Negative energy.");
+                energy = *value;
+            }
+            taskGraph.add(std::move(weights), std::move(energies));
+        } else if (type == 'S') {
+            scanner.curr++;
+            const auto from = scanner.readInt();
+            if (!from) return fail("Expected a source Task id.");
+            if (*from < firstId || *from >= expectedId) return fail("Transfer from an undeclared Task.");
+            if (!scanner.expectChar('>')) return fail("Expected '>'.");
+            const auto to = scanner.readInt();
+            if (!to) return fail("Expected a destination Task id.");
+            if (*to < firstId || *to >= expectedId) return fail("Transfer to an undeclared Task.");
+            if (!scanner.expectChar('|')) return fail("Expected '|'.");
+            const auto volume = scanner.readInt();
+            if (!volume) return fail("Expected a transfer volume.");
+            if (*volume < 0) return fail("Negative transfer volume.");
+            taskGraph.transfers.emplace_back(*from - firstId, *to - firstId, *volume);
+        } else {
+            return fail(std::string("Unexpected beginning of a line: ") + type);
+        }
+    }
+
+    // Link the Tasks only now that every degree is known, so that each list is allocated once
+    std::vector<int> targetsCount(taskGraph.tasks.size(), 0);
+    std::vector<int> parentsCount(taskGraph.tasks.size(), 0);
+    for (const auto& [src, dst, _volume] : taskGraph.transfers) {
+        targetsCount[src]++;
+        parentsCount[dst]++;
+    }
+    for (unsigned int id = 0; id < taskGraph.tasks.size(); id++) {
+        taskGraph.tasks[id].targets.reserve(targetsCount[id]);
+        taskGraph.tasks[id].parents.reserve(parentsCount[id]);
+    }
+    for (const auto& [src, dst, volume] : taskGraph.transfers) {
+        taskGraph.tasks[src].targets.emplace_back(dst, volume);
+        taskGraph.tasks[dst].parents.emplace_back(src);
+    }
+
+    return { std::move(taskGraph) };
+}
+
+std::optional<TaskGraph> readTaskGraph(std::string_view path, ParseError& error) {
+    const MappedFile file(path);
+    if (!file.valid()) {
+        error = { 0, 0, "Could not open the file." };
+        return std::nullopt;
+    }
+    return parseTaskGraph(file.data, file.data + file.size, error);
+}
+
+std::optional<TaskGraph> readTaskGraph(std::string_view path) {
+    ParseError error;
+    auto taskGraph = readTaskGraph(path, error);
+    if (!taskGraph) std::cout << "::> " << path << ":" << error << '\n';
+    return taskGraph;
+}
+
+void writeTaskGraph(std::ostream& os, const TaskGraph& taskGraph) {
+    const int firstId = taskGraph.indexingFromZero ? 0 : 1;
+    os << "V " << taskGraph.policiesCount << '\n';
+    os << "I " << firstId << '\n';
+    int id = firstId;
+    for (const auto& task : taskGraph.tasks) {
+        os << "T " << id++ << " W";
+        for (int w : task.weights) os << ' ' << w;
+        os << " E";
+        for (int e : task.energies) os << ' ' << e;
+        os << '\n';
+    }
+    for (const auto& [src, dst, volume] : taskGraph.transfers) {
+        os << "S " << (src + firstId) << " > " << (dst + firstId) << " | " << volume << '\n';
+    }
+}
+
+// The binary format is the CompactTaskGraph itself: the header followed by the
+// arrays in the order of its members, all in the native int32 representation.
+// So loading is just a mapping of the file, without copies or allocations per Task.
+// The byte order marker tells a file written on a host of the other endianness.
+struct BinaryTaskGraphHeader {
+    static constexpr char MAGIC[4] = { 'E', 'A', 'P', 'G' };
+    static constexpr uint32_t ORDER_MARK = 0x01020304;
+    static constexpr uint32_t SWAPPED_ORDER_MARK = 0x04030201;
+    static constexpr uint32_t VERSION = 2;
+
+    char magic[4];
+    uint32_t byteOrder;
+    uint32_t version;
+    int32_t tasksCount;
+    int32_t policiesCount;
+    int32_t edgesCount;
+    int32_t indexingFromZero;
+};
+
+bool writeBinaryTaskGraph(std::string_view path, const CompactTaskGraph& taskGraph) {
+    // As loadBinaryTaskGraph() takes them
+    const std::size_t matrixSize = static_cast<std::size_t>(taskGraph.tasksCount) * taskGraph.policiesCount;
+    if (matrixSize > static_cast<std::size_t>(std::numeric_limits<int>::max())
+            || taskGraph.tasksCount == std::numeric_limits<int>::max()) {
+        return false;
+    }
+    std::ofstream file(std::string(path), std::ios::binary);
+    BinaryTaskGraphHeader header;
+    std::copy(std::begin(BinaryTaskGraphHeader::MAGIC), std::end(BinaryTaskGraphHeader::MAGIC), header.magic);
+    header.byteOrder = BinaryTaskGraphHeader::ORDER_MARK;
+    header.version = BinaryTaskGraphHeader::VERSION;
+    header.tasksCount = taskGraph.tasksCount;
+    header.policiesCount = taskGraph.policiesCount;
+    header.edgesCount = taskGraph.edgesCount();
+    header.indexingFromZero = taskGraph.indexingFromZero;
+
+    const auto write = [&file](const auto* data, std::size_t count){
+        file.write(reinterpret_cast<const char*>(data), sizeof(*data) * count);
+    };
+    write(&header, 1);
+    write(taskGraph.weights, matrixSize);
+    write(taskGraph.energies, matrixSize);
+    write(taskGraph.successorOffsets, taskGraph.tasksCount + 1u);
+    write(taskGraph.predecessorOffsets, taskGraph.tasksCount + 1u);
+    write(taskGraph.successors, header.edgesCount);
+    write(taskGraph.predecessors, header.edgesCount);
+    return static_cast<bool>(file);
+}
+
+// The views of the CompactTaskGraph keep the mapping alive
+std::optional<CompactTaskGraph> loadBinaryTaskGraph(std::shared_ptr<const MappedFile> file, ParseError& error) {
+    BinaryTaskGraphHeader header;
+    if (file->size < sizeof(header)) {
+        error = { 0, 0, "Too short for a binary task graph." };
+        return std::nullopt;
+    }
+    std::memcpy(&header, file->data, sizeof(header));
+    if (!std::equal(std::begin(header.magic), std::end(header.magic), BinaryTaskGraphHeader::MAGIC)) {
+        error = { 0, 0, "Not a binary task graph." };
+        return std::nullopt;
+    }
+    if (header.byteOrder == BinaryTaskGraphHeader::SWAPPED_ORDER_MARK) {
+        error = { 0, 0, "The binary task graph was written on a host of the other byte order." };
+        return std::nullopt;
+    }
+    if (header.byteOrder != BinaryTaskGraphHeader::ORDER_MARK) {
+        error = { 0, 0, "Corrupt byte order marker in the binary task graph." };
+        return std::nullopt;
+    }
+    if (header.version != BinaryTaskGraphHeader::VERSION) {
+        error = { 0, 0, "Unsupported binary task graph version " + std::to_string(header.version) + "." };
+        return std::nullopt;
+    }
+    if (header.tasksCount < 0 || header.policiesCount < 0 || header.edgesCount < 0) {
+        error = { 0, 0, "Negative sizes in the binary task graph." };
+        return std::nullopt;
+    }
+    const long long tasksCount = header.tasksCount, edgesCount = header.edgesCount;
+    // Each array is bounded by what is left of the file before it is sized, so that
+    // a corrupt header cannot overflow its way past the size check
+    const std::size_t payloadSize = file->size - sizeof(header);
+    std::size_t intsLeft = payloadSize / sizeof(int32_t);
+    const auto take = [&intsLeft](std::size_t count, std::size_t each){
+        if (count > intsLeft / each) return false;
+        intsLeft -= count * each;
+        return true;
+    };
+    const std::size_t tasks = tasksCount, policies = header.policiesCount, edges = edgesCount;
+    if (payloadSize % sizeof(int32_t) != 0
+            || !take(tasks + 1, 2)
+            || (tasks > 0 && !take(policies, 2 * tasks))
+            || !take(edges, 2 * sizeof(CompactTaskGraph::Edge) / sizeof(int32_t))
+            || intsLeft != 0) {
+        error = { 0, 0, "Inconsistent sizes in the binary task graph." };
+        return std::nullopt;
+    }
+    // The accessors index the matrices with an int
+    if (tasks * policies > static_cast<std::size_t>(std::numeric_limits<int>::max())) {
+        error = { 0, 0, "Too many Tasks and policies in the binary task graph." };
+        return std::nullopt;
+    }
+    if (header.indexingFromZero != 0 && header.indexingFromZero != 1) {
+        error = { 0, 0, "Corrupt indexing in the binary task graph." };
+        return std::nullopt;
+    }
+    // As in the text format, even without Tasks
+    if (header.policiesCount == 0) {
+        error = { 0, 0, "No policies in the binary task graph." };
+        return std::nullopt;
+    }
+
+    const int* data = reinterpret_cast<const int*>(file->data + sizeof(header));
+    CompactTaskGraph taskGraph(header.tasksCount, header.policiesCount, header.indexingFromZero,
+            data, std::move(file));
+    // As in the text format
+    const std::size_t matrixSize = tasks * policies;
+    if (std::any_of(taskGraph.weights, taskGraph.weights + matrixSize, [](int w){ return w < 0; })) {
+        error = { 0, 0, "Negative weight in the binary task graph." };
+        return std::nullopt;
+    }
+    if (std::any_of(taskGraph.energies, taskGraph.energies + matrixSize, [](int e){ return e < 0; })) {
+        error = { 0, 0, "Negative energy in the binary task graph." };
+        return std::nullopt;
+    }
+    // A corrupt file must not send the solver out of bounds
+    for (const int* offsets : { taskGraph.successorOffsets, taskGraph.predecessorOffsets }) {
+        if (offsets[0] != 0 || offsets[tasksCount] != edgesCount
+                || !std::is_sorted(offsets, offsets + tasksCount + 1)) {
+            error = { 0, 0, "Corrupt edge offsets in the binary task graph." };
+            return std::nullopt;
+        }
+    }
+    for (const auto* edges : { taskGraph.successors, taskGraph.predecessors }) {
+        for (long long i = 0; i < edgesCount; i++) {
+            if (edges[i].id < 0 || edges[i].id >= tasksCount) {
+                error = { 0, 0, "Corrupt edge in the binary task graph." };
+                return std::nullopt;
+            }
+            if (edges[i].volume < 0) {
+                error = { 0, 0, "Negative transfer volume in the binary task graph." };
+                return std::nullopt;
+            }
+        }
+    }
+    // The predecessors must mirror the successors, at least in the degrees
+    std::vector<int> degreeOf(tasksCount, 0);
+    for (long long i = 0; i < edgesCount; i++) degreeOf[taskGraph.successors[i].id]++;
+    for (int id = 0; id < tasksCount; id++) {
+        if (degreeOf[id] != taskGraph.predecessorsOf(id).size()) {
+            error = { 0, 0, "The predecessors of Task " + std::to_string(id) + " do not mirror the successors." };
+            return std::nullopt;
+        }
+    }
+    std::fill(degreeOf.begin(), degreeOf.end(), 0);
+    for (long long i = 0; i < edgesCount; i++) degreeOf[taskGraph.predecessors[i].id]++;
+    for (int id = 0; id < tasksCount; id++) {
+        if (degreeOf[id] != taskGraph.successorsOf(id).size()) {
+            error = { 0, 0, "The successors of Task " + std::to_string(id) + " do not mirror the predecessors." };
+            return std::nullopt;
+        }
+    }
+
+    return { std::move(taskGraph) };
+}
+
+std::optional<CompactTaskGraph> loadBinaryTaskGraph(std::string_view path, ParseError& error) {
+    auto file = std::make_shared<const MappedFile>(path);
+    if (!file->valid()) {
+        error = { 0, 0, "Could not open the file." };
+        return std::nullopt;
+    }
+    return loadBinaryTaskGraph(std::move(file), error);
+}
+
+TaskGraph toTaskGraph(const CompactTaskGraph& compactTaskGraph) {
+    TaskGraph taskGraph(compactTaskGraph.indexingFromZero);
+    taskGraph.policiesCount = compactTaskGraph.policiesCount;
+    taskGraph.tasks.reserve(compactTaskGraph.tasksCount);
+    taskGraph.transfers.reserve(compactTaskGraph.edgesCount());
+    const int policies = compactTaskGraph.policiesCount;
+    for (int id = 0; id < compactTaskGraph.tasksCount; id++) {
+        const int* weights = compactTaskGraph.weights + id * policies;
+        const int* energies = compactTaskGraph.energies + id * policies;
+        taskGraph.add(std::vector<int>(weights, weights + policies), std::vector<int>(energies, energies + policies));
+    }
+    for (int id = 0; id < compactTaskGraph.tasksCount; id++) {
+        auto& task = taskGraph.tasks[id];
+        const auto targets = compactTaskGraph.successorsOf(id);
+        const auto parents = compactTaskGraph.predecessorsOf(id);
+        task.targets.reserve(targets.size());
+        task.parents.reserve(parents.size());
+        for (const auto& [dst, volume] : targets) {
+            task.targets.emplace_back(dst, volume);
+            taskGraph.transfers.emplace_back(id, dst, volume);
+        }
+        for (const auto& [parent, _volume] : parents) task.parents.push_back(parent);
+    }
+    return taskGraph;
+}
+
+std::optional<LoadedTaskGraph> loadTaskGraph(std::string_view path, ParseError& error) {
+    auto file = std::make_shared<const MappedFile>(path);
+    if (!file->valid()) {
+        error = { 0, 0, "Could not open the file." };
+        return std::nullopt;
+    }
+    const auto& magic = BinaryTaskGraphHeader::MAGIC;
+    if (file->size < sizeof(magic) || !std::equal(std::begin(magic), std::end(magic), file->data)) {
+        auto taskGraph = parseTaskGraph(file->data, file->data + file->size, error);
+        if (!taskGraph) return std::nullopt;
+        return { std::move(*taskGraph) };
+    }
+    auto compactTaskGraph = loadBinaryTaskGraph(std::move(file), error);
+    if (!compactTaskGraph) return std::nullopt;
+    return { std::move(*compactTaskGraph) };
+}
+
+bool convertToBinary(std::string_view textPath, std::string_view binaryPath) {
+    const auto taskGraph = readTaskGraph(textPath);
+    if (!taskGraph) return false;
+    if (!writeBinaryTaskGraph(binaryPath, CompactTaskGraph(*taskGraph))) {
+        std::cout << "::> Could not write " << binaryPath << '\n';
+        return false;
+    }
+    return true;
+}
+
+bool convertToText(std::string_view binaryPath, std::string_view textPath) {
+    ParseError error;
+    const auto compactTaskGraph = loadBinaryTaskGraph(binaryPath, error);
+    if (!compactTaskGraph) {
+        std::cout << "::> " << binaryPath << ":" << error << '\n';
+        return false;
+    }
+    std::ofstream file{std::string(textPath)};
+    writeTaskGraph(file, toTaskGraph(*compactTaskGraph));
+    if (!file) {
+        std::cout << "::> Could not write " << textPath << '\n';
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <optional>
+#include <variant>
+#include "taskGraph.h"
+
+
+// Read-only mapping of a whole file
+struct MappedFile {
+    const char* data = nullptr;
+    size_t size = 0;
+
+    explicit MappedFile(std::string_view path);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool valid() const noexcept { return opened; }
+
+private:
+    bool opened = false;
+};
+
+struct ParseError {
+    int line = 0, column = 0; // from 1, or 0 when not tied to a position
+    std::string message;
+};
+
+std::ostream& operator<<(std::ostream& os, const ParseError& error);
+
+// One pass over the text. The Tasks and transfers are counted up front to
+// reserve the storage (the letters T and S appear nowhere else in the format).
+std::optional<TaskGraph> parseTaskGraph(const char* begin, const char* end, ParseError& error);
+
+std::optional<TaskGraph> readTaskGraph(std::string_view path, ParseError& error);
+
+std::optional<TaskGraph> readTaskGraph(std::string_view path);
+
+void writeTaskGraph(std::ostream& os, const TaskGraph& taskGraph);
+
+// False if the file could not be written, or the graph is too large for the format
+bool writeBinaryTaskGraph(std::string_view path, const CompactTaskGraph& taskGraph);
+
+std::optional<CompactTaskGraph> loadBinaryTaskGraph(std::string_view path, ParseError& error);
+
+// The per-Task lists are rebuilt in their stored order
+TaskGraph toTaskGraph(const CompactTaskGraph& compactTaskGraph);
+
+// A text file parsed, or a binary one as it is mapped
+using LoadedTaskGraph = std::variant<TaskGraph, CompactTaskGraph>;
+
+// Text or binary, told apart by the magic of the binary format. The file is mapped once
+std::optional<LoadedTaskGraph> loadTaskGraph(std::string_view path, ParseError& error);
+
+bool convertToBinary(std::string_view textPath, std::string_view binaryPath);
+
+bool convertToText(std::string_view binaryPath, std::string_view textPath);
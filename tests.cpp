@@ -0,0 +1,513 @@
+// Checks of the solver parts against plain references, on small random
+// instances: every check compares the fast version with a simple one that
+// is obviously right, such as the linear scan it replaced or a brute force.
+//
+// ./tests [--seed 302] [--rounds 200]
+//
+// Prints a line per check that fails and one per test, and returns non-zero
+// if any check failed. make test builds and runs it.
+#include <iostream>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <sstream>
+#include <random>
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <cstring>
+#include <climits>
+#include <filesystem>
+#include "freeSlots.h"
+#include "maxFlow.h"
+#include "taskGraph.h"
+#include "taskGraphIO.h"
+#include "criticalPath.h"
+#include "generators.h"
+#include "network.h"
+#include "planning.h"
+
+
+int failures = 0;
+
+// Reports the check if it failed, with what it was about
+void check(bool passed, std::string_view test, const std::string& what) {
+    if (passed) return;
+    failures++;
+    std::cout << "::> " << test << ": " << what << '\n';
+}
+
+template<typename... Values>
+std::string describe(const Values&... values) {
+    std::ostringstream os;
+    ((os << values << ' '), ...);
+    return os.str();
+}
+
+
+// The earliest start at or after let by the linear scan of the Processor before
+// the free slots: over the events again after every conflict
+int availableAtByScan(const std::vector<std::pair<int, int>>& events, int duration, int let) {
+    bool conflict = true;
+    while (conflict) {
+        conflict = false;
+        for (const auto& [start, finish] : events) {
+            if (finish <= let || let + duration <= start) continue;
+            conflict = true;
+            let = finish;
+            break;
+        }
+    }
+    return let;
+}
+
+void testFreeSlots(std::mt19937& engine, int rounds) {
+    const std::string_view test = "free_slots";
+    std::uniform_int_distribution<int> randomDuration(0, 12), randomLet(0, 150);
+    FreeSlots freeSlots;
+    for (int round = 0; round < rounds; round++) {
+        freeSlots.clear();
+        std::vector<std::pair<int, int>> events;
+        for (int step = 0; step < 40; step++) {
+            const int duration = randomDuration(engine), let = randomLet(engine);
+            const int expected = availableAtByScan(events, duration, let);
+            const auto [time, end] = freeSlots.earliestWindow(duration, let);
+            check(time == expected, test, describe("earliestFit", duration, let, "gave", time, "not", expected));
+            // The window ends where the next event starts, if any
+            int nextStart = FreeSlots::UNBOUNDED;
+            for (const auto& [start, _finish] : events) {
+                if (start >= time + duration) nextStart = std::min(nextStart, start);
+            }
+            check(end == nextStart, test, describe("window of", duration, let, "ends at", end, "not", nextStart));
+
+            if (duration == 0) continue;
+            events.emplace_back(time, time + duration);
+            freeSlots.occupy(time, time + duration);
+            int lastFinish = 0;
+            for (const auto& [_start, finish] : events) lastFinish = std::max(lastFinish, finish);
+            check(freeSlots.lastStart() == lastFinish, test,
+                    describe("last finish", freeSlots.lastStart(), "not", lastFinish));
+        }
+    }
+}
+
+
+// A random graph of up to maxTasks Tasks on random policies, with Early and Late
+struct RandomInstance {
+    TaskGraph taskGraph;
+    CompactTaskGraph compactTaskGraph;
+    std::vector<int> rootTaskIndices, topologicalOrder;
+
+    RandomInstance(std::mt19937& engine, int maxTasks)
+            : taskGraph(generateRandomTaskGraph(getRandomUniformInt(engine, 1, maxTasks),
+                    getRandomUniformInt(engine, 1, 4), getRandomUniformInt(engine, 0, 40) / 100.0f,
+                    3, 10, 1, 3, engine).first),
+              compactTaskGraph(taskGraph),
+              rootTaskIndices(getRootTasks(taskGraph)),
+              topologicalOrder(getTopologicalOrder(taskGraph)) {
+        for (auto& task : taskGraph.tasks) task.policy = getRandomUniformInt(engine, 0, taskGraph.policiesCount - 1);
+        recalculateEarlyLate(taskGraph, compactTaskGraph, topologicalOrder);
+    }
+};
+
+bool samePlanning(const PlanningStuff& planningStuff, const PlanningStuff& other) {
+    if (planningStuff.assignmentOf != other.assignmentOf || planningStuff.startOf != other.startOf
+            || planningStuff.arrivalOf != other.arrivalOf || planningStuff.plannedOrder != other.plannedOrder) {
+        return false;
+    }
+    for (unsigned int core = 0; core < planningStuff.processors.size(); core++) {
+        const auto& processor = planningStuff.processors[core];
+        const auto& otherProcessor = other.processors[core];
+        const bool sameProcessing = std::equal(processor.processingTimeline.begin(), processor.processingTimeline.end(),
+                otherProcessor.processingTimeline.begin(), otherProcessor.processingTimeline.end(),
+                [](const auto& event, const auto& otherEvent){
+                    return event.start == otherEvent.start && event.finish == otherEvent.finish
+                        && event.taskId == otherEvent.taskId;
+                });
+        const bool sameTransfers = std::equal(processor.transferTimeline.begin(), processor.transferTimeline.end(),
+                otherProcessor.transferTimeline.begin(), otherProcessor.transferTimeline.end(),
+                [](const auto& event, const auto& otherEvent){
+                    return event.start == otherEvent.start && event.duration == otherEvent.duration
+                        && event.src == otherEvent.src && event.dst == otherEvent.dst;
+                });
+        if (!sameProcessing || !sameTransfers) return false;
+    }
+    return true;
+}
+
+// The Early and Late that the tracker keeps after one policy change at a time
+// against recalculating them from scratch, with the critical time of the roots
+void testTracker(std::mt19937& engine, int rounds) {
+    const std::string_view test = "tracker";
+    for (int round = 0; round < rounds; round++) {
+        RandomInstance instance(engine, 30);
+        auto& [taskGraph, compactTaskGraph, rootTaskIndices, topologicalOrder] = instance;
+        const int tasksCount = taskGraph.tasks.size();
+        CriticalPathTracker tracker(taskGraph, compactTaskGraph, rootTaskIndices, topologicalOrder);
+        for (int change = 0; change < 10; change++) {
+            const int id = getRandomUniformInt(engine, 0, tasksCount - 1);
+            taskGraph.tasks[id].policy = getRandomUniformInt(engine, 0, taskGraph.policiesCount - 1);
+            tracker.taskChanged(id);
+
+            TaskGraph recalculated = taskGraph;
+            recalculateEarlyLate(recalculated, compactTaskGraph, topologicalOrder);
+            for (int task = 0; task < tasksCount; task++) {
+                const auto& kept = taskGraph.tasks[task];
+                const auto& expected = recalculated.tasks[task];
+                check(kept.early == expected.early && kept.late == expected.late, test,
+                        describe("round", round, "change", change, "Task", task, "early", *kept.early, "late",
+                            *kept.late, "instead of", *expected.early, *expected.late));
+            }
+            int criticalTime = 0;
+            for (int root : rootTaskIndices) criticalTime = std::max(criticalTime, -*recalculated.tasks[root].late);
+            check(tracker.criticalTime() == criticalTime, test, describe("round", round, "change", change,
+                        "critical time", tracker.criticalTime(), "instead of", criticalTime));
+        }
+    }
+}
+
+// Replanning after some policies, pins and priority biases change, as the
+// local search does, against planning anew from the same state
+void testReplanning(std::mt19937& engine, int rounds) {
+    const std::string_view test = "replanning";
+    const char* networks[] = { "ideal", "bus:2", "crossbar", "ring:1", "mesh:2" };
+    const Scheduler schedulers[] = { Scheduler::Delta, Scheduler::Heft, Scheduler::Peft };
+    const std::vector<CoreProfile> profiles{ { 150, 180 }, { 60, 40 } };
+    for (int round = 0; round < rounds; round++) {
+        RandomInstance instance(engine, 30);
+        auto& [taskGraph, compactTaskGraph, rootTaskIndices, topologicalOrder] = instance;
+        const int tasksCount = taskGraph.tasks.size();
+        const int coresCount = getRandomUniformInt(engine, 1, 4);
+        const char* network = networks[getRandomUniformInt(engine, 0, 4)];
+        const Scheduler scheduler = schedulers[getRandomUniformInt(engine, 0, 2)];
+        const bool profiled = getRandomUniformInt(engine, 0, 1);
+        const auto setUp = [&](PlanningStuff& planningStuff){
+            planningStuff.network.model = *parseNetworkModel(network);
+            planningStuff.setCoreProfiles(profiled ? profiles : std::vector<CoreProfile>(), coresCount);
+            planningStuff.schedulers.assign(1, scheduler);
+        };
+
+        PlanningStuff replanned;
+        setUp(replanned);
+        replanned.pinnedCoreOf.assign(tasksCount, -1);
+        replanned.priorityBiasOf.assign(tasksCount, 0);
+        planning(taskGraph, compactTaskGraph, rootTaskIndices, coresCount, replanned);
+        for (int move = 0; move < 5; move++) {
+            for (int changes = getRandomUniformInt(engine, 1, 3); changes > 0; changes--) {
+                const int id = getRandomUniformInt(engine, 0, tasksCount - 1);
+                switch (getRandomUniformInt(engine, 0, 2)) {
+                    case 0: taskGraph.tasks[id].policy = getRandomUniformInt(engine, 0, taskGraph.policiesCount - 1); break;
+                    case 1: replanned.pinnedCoreOf[id] = getRandomUniformInt(engine, -1, coresCount - 1); break;
+                    case 2: replanned.priorityBiasOf[id] += getRandomUniformInt(engine, -20, 20); break;
+                }
+            }
+            recalculateEarlyLate(taskGraph, compactTaskGraph, topologicalOrder);
+            replanning(taskGraph, compactTaskGraph, rootTaskIndices, coresCount, replanned);
+
+            PlanningStuff planned;
+            setUp(planned);
+            planned.pinnedCoreOf = replanned.pinnedCoreOf;
+            planned.priorityBiasOf = replanned.priorityBiasOf;
+            planning(taskGraph, compactTaskGraph, rootTaskIndices, coresCount, planned);
+            check(samePlanning(replanned, planned), test, describe("round", round, "move", move, "on", network,
+                        "with", nameOf(scheduler), "differs from planning anew"));
+        }
+    }
+}
+
+
+// The maximum flow against the least cut of all the source sides on graphs
+// small enough to try every one of them, with the cut that run() leaves too
+void testMaxFlow(std::mt19937& engine, int rounds) {
+    const std::string_view test = "max_flow";
+    MaxFlow maxFlow;
+    for (int round = 0; round < rounds; round++) {
+        const int nodesCount = getRandomUniformInt(engine, 2, 8);
+        const int source = 0, sink = nodesCount - 1;
+        std::vector<std::vector<long long>> capacityOf(nodesCount, std::vector<long long>(nodesCount, 0));
+        maxFlow.reset(nodesCount);
+        for (int edges = getRandomUniformInt(engine, 0, 3 * nodesCount); edges > 0; edges--) {
+            const int from = getRandomUniformInt(engine, 0, nodesCount - 1);
+            const int to = getRandomUniformInt(engine, 0, nodesCount - 1);
+            if (from == to) continue;
+            const long long capacity = getRandomUniformInt(engine, 0, 10);
+            capacityOf[from][to] += capacity; // parallel edges add up
+            maxFlow.addEdge(from, to, capacity);
+        }
+        const auto cutOf = [&capacityOf, nodesCount](const auto& onSourceSide){
+            long long capacity = 0;
+            for (int from = 0; from < nodesCount; from++) {
+                for (int to = 0; to < nodesCount; to++) {
+                    if (onSourceSide(from) && !onSourceSide(to)) capacity += capacityOf[from][to];
+                }
+            }
+            return capacity;
+        };
+        long long leastCut = -1;
+        for (int sides = 0; sides < (1 << nodesCount); sides++) {
+            if (!(sides >> source & 1) || (sides >> sink & 1)) continue;
+            const long long capacity = cutOf([sides](int node){ return (sides >> node & 1) != 0; });
+            if (leastCut == -1 || capacity < leastCut) leastCut = capacity;
+        }
+
+        const long long flow = maxFlow.run(source, sink);
+        check(flow == leastCut, test, describe("round", round, "flow", flow, "not", leastCut));
+        const long long cut = cutOf([&maxFlow](int node){ return maxFlow.onSourceSide(node); });
+        check(cut == flow, test, describe("round", round, "cut of", cut, "for a flow of", flow));
+    }
+}
+
+// The critical cut against every set of critical Tasks on graphs small enough:
+// the cheapest of those on every critical path, by energy and then by size
+void testCriticalCut(std::mt19937& engine, int rounds) {
+    const std::string_view test = "critical_cut";
+    MaxFlow maxFlow;
+    std::vector<int> nodeOf, cut;
+    for (int round = 0; round < rounds; round++) {
+        RandomInstance instance(engine, 12);
+        auto& [taskGraph, compactTaskGraph, rootTaskIndices, topologicalOrder] = instance;
+        const int tasksCount = taskGraph.tasks.size();
+        const int criticalTime = recalculateStats(taskGraph, compactTaskGraph, rootTaskIndices, topologicalOrder).second;
+        findCriticalCut(taskGraph, compactTaskGraph, criticalTime, maxFlow, nodeOf, cut);
+
+        std::vector<int> critical;
+        for (int id = 0; id < tasksCount; id++) {
+            if (*taskGraph.tasks[id].early - *taskGraph.tasks[id].late == criticalTime) critical.push_back(id);
+        }
+        const auto finishOf = [&](int id){
+            return *taskGraph.tasks[id].early + compactTaskGraph.weight(id, taskGraph.tasks[id].policy);
+        };
+        const auto costOf = [&](int id){
+            const int policy = taskGraph.tasks[id].policy;
+            return std::max(compactTaskGraph.energy(id, policy - 1) - compactTaskGraph.energy(id, policy), 0);
+        };
+        // Whether no critical path gets from a start to the end around the Tasks taken,
+        // the critical Tasks being in topological order
+        std::vector<bool> reached(tasksCount);
+        const auto cutsEveryPath = [&](const std::vector<bool>& taken){
+            std::fill(reached.begin(), reached.end(), false);
+            for (int id : topologicalOrder) {
+                const auto& task = taskGraph.tasks[id];
+                if (*task.early - *task.late != criticalTime || taken[id]) continue;
+                bool fromStart = *task.early == 0;
+                for (const auto& [parent, _volume] : compactTaskGraph.predecessorsOf(id)) {
+                    if (reached[parent] && finishOf(parent) == *task.early) fromStart = true;
+                }
+                reached[id] = fromStart;
+                if (fromStart && finishOf(id) == criticalTime) return false;
+            }
+            return true;
+        };
+
+        std::pair<long long, int> best{ -1, 0 }; // <cost, size>
+        std::vector<bool> taken(tasksCount);
+        const int criticalCount = critical.size();
+        for (int subset = 0; subset < (1 << criticalCount); subset++) {
+            std::fill(taken.begin(), taken.end(), false);
+            bool improvable = true;
+            std::pair<long long, int> cost{ 0, 0 };
+            for (int i = 0; i < criticalCount; i++) {
+                if (!(subset >> i & 1)) continue;
+                const int id = critical[i];
+                improvable = improvable && taskGraph.tasks[id].canImprove();
+                taken[id] = true;
+                cost.first += improvable ? costOf(id) : 0;
+                cost.second++;
+            }
+            if (!improvable || !cutsEveryPath(taken)) continue;
+            if (best.first == -1 || cost < best) best = cost;
+        }
+
+        if (best.first == -1) {
+            check(cut.empty(), test, describe("round", round, "found a cut where none can be"));
+            continue;
+        }
+        std::fill(taken.begin(), taken.end(), false);
+        std::pair<long long, int> cost{ 0, cut.size() };
+        bool improvable = true;
+        for (int id : cut) {
+            taken[id] = true;
+            improvable = improvable && taskGraph.tasks[id].canImprove();
+            if (improvable) cost.first += costOf(id);
+        }
+        check(!cut.empty() && improvable && cutsEveryPath(taken), test,
+                describe("round", round, "the cut of", cut.size(), "Tasks misses a critical path"));
+        check(cost == best, test, describe("round", round, "the cut costs", cost.first, "in", cost.second,
+                    "Tasks, not", best.first, "in", best.second));
+    }
+}
+
+
+bool sameCompactGraph(const CompactTaskGraph& compactTaskGraph, const CompactTaskGraph& other) {
+    if (compactTaskGraph.tasksCount != other.tasksCount || compactTaskGraph.policiesCount != other.policiesCount
+            || compactTaskGraph.indexingFromZero != other.indexingFromZero
+            || compactTaskGraph.edgesCount() != other.edgesCount()) {
+        return false;
+    }
+    const int matrixSize = compactTaskGraph.tasksCount * compactTaskGraph.policiesCount;
+    const auto sameEdges = [](const CompactTaskGraph::Edge* edges, const CompactTaskGraph::Edge* otherEdges, int count){
+        return std::equal(edges, edges + count, otherEdges, [](const auto& edge, const auto& otherEdge){
+            return edge.id == otherEdge.id && edge.volume == otherEdge.volume;
+        });
+    };
+    return std::equal(compactTaskGraph.weights, compactTaskGraph.weights + matrixSize, other.weights)
+        && std::equal(compactTaskGraph.energies, compactTaskGraph.energies + matrixSize, other.energies)
+        && std::equal(compactTaskGraph.successorOffsets, compactTaskGraph.successorOffsets
+                + compactTaskGraph.tasksCount + 1, other.successorOffsets)
+        && std::equal(compactTaskGraph.predecessorOffsets, compactTaskGraph.predecessorOffsets
+                + compactTaskGraph.tasksCount + 1, other.predecessorOffsets)
+        && sameEdges(compactTaskGraph.successors, other.successors, compactTaskGraph.edgesCount())
+        && sameEdges(compactTaskGraph.predecessors, other.predecessors, compactTaskGraph.edgesCount());
+}
+
+std::string temporaryPath(std::string_view name) {
+    return (std::filesystem::temp_directory_path() / ("tests_" + std::string(name)))
+        .string();
+}
+
+// Random graphs, and one without Tasks, through the text and the binary
+// formats and back: the same graph each way, whichever the indexing
+void testRoundTrip(std::mt19937& engine, int rounds) {
+    const std::string_view test = "round_trip";
+    const std::string path = temporaryPath("round_trip.eapg");
+    for (int round = 0; round <= rounds; round++) {
+        TaskGraph taskGraph(true);
+        if (round < rounds) {
+            taskGraph = generateRandomTaskGraph(getRandomUniformInt(engine, 1, 30), getRandomUniformInt(engine, 1, 4),
+                    getRandomUniformInt(engine, 0, 40) / 100.0f, 3, 10, 1, 3, engine).first;
+            taskGraph.indexingFromZero = getRandomUniformInt(engine, 0, 1);
+        } else {
+            taskGraph.policiesCount = 3;
+        }
+        const CompactTaskGraph compactTaskGraph(taskGraph);
+        std::ostringstream text;
+        writeTaskGraph(text, taskGraph);
+        const std::string written = text.str();
+
+        ParseError error;
+        const auto parsed = parseTaskGraph(written.data(), written.data() + written.size(), error);
+        check(parsed && sameCompactGraph(CompactTaskGraph(*parsed), compactTaskGraph), test,
+                describe("round", round, "differs through the text format"));
+
+        check(writeBinaryTaskGraph(path, compactTaskGraph), test, describe("round", round, "could not be written"));
+        const auto loaded = loadTaskGraph(path, error);
+        const auto* mapped = loaded ? std::get_if<CompactTaskGraph>(&*loaded) : nullptr;
+        check(mapped && sameCompactGraph(*mapped, compactTaskGraph), test,
+                describe("round", round, "differs through the binary format:", error.message));
+        if (!mapped) continue;
+        check(sameCompactGraph(CompactTaskGraph(toTaskGraph(*mapped)), compactTaskGraph), test,
+                describe("round", round, "differs back from the binary format"));
+    }
+    std::filesystem::remove(path);
+}
+
+// A valid binary file with one thing broken at a time, which must be rejected.
+// The header is 7 words (magic, byte order, version, Tasks, policies, transfers,
+// indexing), then weights, energies, successor and predecessor offsets, and
+// the successors and predecessors as <id, volume>.
+void testBinaryHeaders(std::mt19937& engine, int rounds) {
+    const std::string_view test = "binary_headers";
+    const std::string path = temporaryPath("binary_headers.eapg");
+    TaskGraph taskGraph(true);
+    for (int id = 0; id < 3; id++) taskGraph.add({ 5, 3 }, { 2, 4 });
+    taskGraph.addTransfer(0, 1, 2);
+    taskGraph.addTransfer(0, 2, 1);
+    taskGraph.addTransfer(1, 2, 3);
+    check(writeBinaryTaskGraph(path, CompactTaskGraph(taskGraph)), test, "could not be written");
+    std::string valid;
+    {
+        std::ifstream file(path, std::ios::binary);
+        valid.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    const auto loads = [&path](const std::string& bytes, ParseError& error){
+        std::ofstream(path, std::ios::binary) << bytes;
+        return loadBinaryTaskGraph(path, error).has_value();
+    };
+    ParseError error;
+    check(valid.size() == 39 * sizeof(int32_t) && loads(valid, error), test, "the valid file is rejected");
+
+    const int header = 7, weights = header, energies = weights + 6, successorOffsets = energies + 6;
+    const int successors = successorOffsets + 8, predecessors = successors + 6;
+    const std::pair<const char*, std::pair<int, int32_t>> brokenWords[] = {
+        { "magic", { 0, 0x47504158 } },
+        { "swapped byte order", { 1, 0x04030201 } },
+        { "corrupt byte order", { 1, 5 } },
+        { "version", { 2, 1 } },
+        { "negative Tasks", { 3, -1 } },
+        { "most Tasks", { 3, INT_MAX } },
+        { "no policies", { 4, 0 } },
+        { "more policies", { 4, 3 } },
+        { "more transfers", { 5, 4 } },
+        { "negative transfers", { 5, -1 } },
+        { "indexing", { 6, 2 } },
+        { "negative weight", { weights, -1 } },
+        { "negative energy", { energies + 5, -1 } },
+        { "first offset", { successorOffsets, 1 } },
+        { "unsorted offsets", { successorOffsets + 1, 4 } },
+        { "successor out of range", { successors, 3 } },
+        { "negative successor", { successors + 2, -1 } },
+        { "negative volume", { predecessors + 1, -1 } },
+        { "predecessors that do not mirror", { predecessors, 2 } },
+    };
+    for (const auto& [what, broken] : brokenWords) {
+        std::string bytes = valid;
+        std::memcpy(bytes.data() + broken.first * sizeof(int32_t), &broken.second, sizeof(int32_t));
+        error = ParseError();
+        check(!loads(bytes, error) && !error.message.empty(), test, describe("accepts a file with", what));
+    }
+    const std::pair<const char*, std::string> brokenSizes[] = {
+        { "the last word cut", valid.substr(0, valid.size() - sizeof(int32_t)) },
+        { "a byte cut", valid.substr(0, valid.size() - 1) },
+        { "a word more", valid + std::string(sizeof(int32_t), '\0') },
+        { "half the header", valid.substr(0, 10) },
+        { "nothing", std::string() },
+    };
+    for (const auto& [what, bytes] : brokenSizes) {
+        error = ParseError();
+        check(!loads(bytes, error) && !error.message.empty(), test, describe("accepts a file with", what));
+    }
+    std::filesystem::remove(path);
+}
+
+
+int main(int argc, char* argv[]) {
+    unsigned int seed = 302;
+    int rounds = 200;
+    for (int i = 1; i < argc; i++) {
+        const std::string_view option = argv[i];
+        if (i + 1 == argc) {
+            std::cout << "::> Expected a value after " << option << '\n';
+            return -1;
+        }
+        const std::string_view value = argv[++i];
+        unsigned int number = 0;
+        const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), number);
+        if (error != std::errc() || end != value.data() + value.size() || (option == "--rounds" && number == 0)) {
+            std::cout << "::> Invalid value for " << option << ": " << value << '\n';
+            return -1;
+        }
+        if (option == "--seed") seed = number;
+        else if (option == "--rounds") rounds = number;
+        else {
+            std::cout << "::> Unknown option " << option << '\n';
+            return -1;
+        }
+    }
+
+    const std::pair<std::string_view, void (*)(std::mt19937&, int)> tests[] = {
+        { "free_slots", testFreeSlots },
+        { "tracker", testTracker },
+        { "replanning", testReplanning },
+        { "max_flow", testMaxFlow },
+        { "critical_cut", testCriticalCut },
+        { "round_trip", testRoundTrip },
+        { "binary_headers", testBinaryHeaders },
+    };
+    for (const auto& [name, test] : tests) {
+        std::mt19937 engine(seed); // every test on its own instances, whatever runs before it
+        const int failuresBefore = failures;
+        test(engine, rounds);
+        std::cout << name << ": " << (failures == failuresBefore ? "ok" : "FAILED") << '\n';
+    }
+    return failures == 0 ? 0 : 1;
+}
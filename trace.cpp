@@ -0,0 +1,97 @@
+#include "trace.h"
+
+#include <algorithm>
+#include "json.h"
+
+
+const char* nameOf(Trace::Counter counter) noexcept {
+    switch (counter) {
+        case Trace::Counter::Recalculations: return "recalculations";
+        case Trace::Counter::SchedulingPasses: return "scheduling_passes";
+        case Trace::Counter::AvailableAtProbes: return "available_at_probes";
+        case Trace::Counter::PolicyDecrements: return "policy_decrements";
+    }
+    return "";
+}
+
+std::optional<TraceFormat> parseTraceFormat(std::string_view name) noexcept {
+    if (name == "chrome") return { TraceFormat::Chrome };
+    if (name == "csv") return { TraceFormat::Csv };
+    return std::nullopt;
+}
+
+void writeCsvLabel(std::ostream& os, std::string_view text) {
+    os << '"';
+    for (char c : text) {
+        if (c == '"') os << '"'; // doubled
+        os << c;
+    }
+    os << '"';
+}
+
+void writeChromeTrace(std::ostream& os, const std::vector<Trace>& traces) {
+    os << "{\"traceEvents\": [";
+    bool first = true;
+    const auto nextEvent = [&os, &first](){
+        os << (first ? "\n" : ",\n");
+        first = false;
+    };
+    for (const auto& trace : traces) {
+        double endUs = 0.0;
+        for (const auto& [name, startUs, durationUs] : trace.spans) {
+            nextEvent();
+            os << "{\"name\": \"" << name << "\", \"cat\": \"stage\", \"ph\": \"X\", \"ts\": " << startUs
+                << ", \"dur\": " << durationUs << ", \"pid\": 1, \"tid\": " << trace.thread << ", \"args\": {\"label\": ";
+            writeJsonString(os, trace.label);
+            os << "}}";
+            endUs = std::max(endUs, startUs + durationUs);
+        }
+        for (const auto& [stage, iteration, timeUs, criticalTime, energy] : trace.samples) {
+            nextEvent();
+            os << "{\"name\": ";
+            writeJsonString(os, trace.label + ": " + stage);
+            os << ", \"ph\": \"C\", \"ts\": " << timeUs << ", \"pid\": 1, \"tid\": " << trace.thread
+                << ", \"args\": {\"critical_time\": " << criticalTime << ", \"energy\": " << energy << "}}";
+            endUs = std::max(endUs, timeUs);
+        }
+        nextEvent();
+        os << "{\"name\": \"counters\", \"ph\": \"i\", \"s\": \"t\", \"ts\": " << endUs
+            << ", \"pid\": 1, \"tid\": " << trace.thread << ", \"args\": {\"label\": ";
+        writeJsonString(os, trace.label);
+        for (int counter = 0; counter < Trace::COUNTERS_COUNT; counter++) {
+            os << ", \"" << nameOf(static_cast<Trace::Counter>(counter)) << "\": " << trace.counters[counter];
+        }
+        os << "}}";
+    }
+    os << "\n]}\n";
+}
+
+void writeCsvTrace(std::ostream& os, const std::vector<Trace>& traces) {
+    os << "event,label,thread,name,time_us,duration_us,iteration,critical_time,energy,count\n";
+    for (const auto& trace : traces) {
+        const auto writeStart = [&os, &trace](const char* event){
+            os << event << ',';
+            writeCsvLabel(os, trace.label);
+            os << ',' << trace.thread << ',';
+        };
+        for (const auto& [name, startUs, durationUs] : trace.spans) {
+            writeStart("span");
+            os << name << ',' << startUs << ',' << durationUs << ",,,,\n";
+        }
+        for (const auto& [stage, iteration, timeUs, criticalTime, energy] : trace.samples) {
+            writeStart("sample");
+            os << stage << ',' << timeUs << ",," << iteration << ',' << criticalTime << ',' << energy << ",\n";
+        }
+        for (int counter = 0; counter < Trace::COUNTERS_COUNT; counter++) {
+            writeStart("counter");
+            os << nameOf(static_cast<Trace::Counter>(counter)) << ",,,,,," << trace.counters[counter] << '\n';
+        }
+    }
+}
+
+void writeTraces(std::ostream& os, const std::vector<Trace>& traces, TraceFormat format) {
+    switch (format) {
+        case TraceFormat::Chrome: writeChromeTrace(os, traces); break;
+        case TraceFormat::Csv: writeCsvTrace(os, traces); break;
+    }
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <optional>
+#include <string_view>
+
+
+// Where the time of a run goes: timed spans, counters of the work done and the
+// critical time and energy per iteration. Nothing is recorded through a null Trace*.
+struct Trace {
+    enum class Counter {
+        Recalculations, // of the Early and Late of a Task
+        SchedulingPasses, // planning() and replanning() runs, each scheduler apart
+        AvailableAtProbes, // free slot searches on the Processor timelines
+        PolicyDecrements // Tasks sped up by a policy
+    };
+    static constexpr int COUNTERS_COUNT = 4;
+
+    struct Span {
+        const char* name;
+        double startUs, durationUs;
+    };
+
+    // After an iteration of a stage: a speedup step, a minimizeEnergy() iteration
+    // or an improvePlanning() round, whose critical time is the makespan
+    struct Sample {
+        const char* stage;
+        int iteration;
+        double timeUs;
+        int criticalTime;
+        int energy;
+    };
+
+    std::string label; // of the run, e.g. the instance
+    int thread = 0; // that the run is on
+    std::chrono::steady_clock::time_point origin; // of the times, shared by the traces written together
+    long long counters[COUNTERS_COUNT] = {};
+    std::vector<Span> spans; // in the order they finish
+    std::vector<Sample> samples;
+
+    explicit Trace(std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now()) noexcept
+        : origin(origin) {}
+
+    double nowUs() const noexcept {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - origin).count();
+    }
+
+    void count(Counter counter, long long times = 1) noexcept { counters[static_cast<int>(counter)] += times; }
+    long long counted(Counter counter) const noexcept { return counters[static_cast<int>(counter)]; }
+
+    void sample(const char* stage, int iteration, int criticalTime, int energy) {
+        samples.push_back({ stage, iteration, nowUs(), criticalTime, energy });
+    }
+};
+
+// Records its scope as a span of the trace, if any
+struct ScopedTimer {
+    Trace* const trace;
+    const char* const name;
+    const double startUs;
+
+    ScopedTimer(Trace* trace, const char* name) noexcept
+        : trace(trace), name(name), startUs(trace ? trace->nowUs() : 0.0) {}
+    ~ScopedTimer() {
+        if (trace) trace->spans.push_back({ name, startUs, trace->nowUs() - startUs });
+    }
+};
+
+const char* nameOf(Trace::Counter counter) noexcept;
+
+enum class TraceFormat {
+    Chrome, // the JSON of chrome://tracing and Perfetto
+    Csv
+};
+
+// "chrome" or "csv"
+std::optional<TraceFormat> parseTraceFormat(std::string_view name) noexcept;
+
+// The traces of one process, each on its thread: as Chrome trace events, or as CSV rows of
+// event,label,thread,name,time_us,duration_us,iteration,critical_time,energy,count
+void writeTraces(std::ostream& os, const std::vector<Trace>& traces, TraceFormat format);
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <optional>
+
+
+struct WorkerReport {
+    int tasksRun = 0;
+    int tasksStolen = 0;
+    double busyMs = 0.0;
+};
+
+// Runs run(task, worker) for every task in [0, tasksCount) on workersCount threads,
+// the calling one included, an idle worker stealing from the back of the others
+template<typename Run>
+std::vector<WorkerReport> runWorkStealing(int tasksCount, int workersCount, Run&& run) {
+    struct Worker {
+        std::mutex mutex;
+        std::deque<int> tasks;
+    };
+    std::vector<Worker> workers(workersCount);
+    for (int worker = 0; worker < workersCount; worker++) {
+        const long long first = static_cast<long long>(tasksCount) * worker / workersCount;
+        const long long last = static_cast<long long>(tasksCount) * (worker + 1) / workersCount;
+        for (long long task = first; task < last; task++) workers[worker].tasks.push_back(task);
+    }
+
+    const auto take = [&workers](int worker, bool fromFront) -> std::optional<int> {
+        std::lock_guard<std::mutex> lock(workers[worker].mutex);
+        auto& tasks = workers[worker].tasks;
+        if (tasks.empty()) return std::nullopt;
+        const int task = fromFront ? tasks.front() : tasks.back();
+        if (fromFront) tasks.pop_front();
+        else tasks.pop_back();
+        return { task };
+    };
+
+    std::vector<WorkerReport> reports(workersCount);
+    const auto work = [&](int worker){
+        auto& report = reports[worker];
+        while (true) {
+            std::optional<int> task = take(worker, true);
+            for (int offset = 1; !task && offset < workersCount; offset++) {
+                task = take((worker + offset) % workersCount, false);
+                if (task) report.tasksStolen++;
+            }
+            if (!task) return;
+
+            const auto start = std::chrono::steady_clock::now();
+            run(*task, worker);
+            const auto finish = std::chrono::steady_clock::now();
+            report.tasksRun++;
+            report.busyMs += std::chrono::duration<double, std::milli>(finish - start).count();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int worker = 1; worker < workersCount; worker++) threads.emplace_back(work, worker);
+    work(0);
+    for (auto& thread : threads) thread.join();
+    return reports;
+}